@@ -33,16 +33,6 @@
 #define newRailSwitchGroupButton(zone, leftX, topY, railSwitchGroup) \
 	newWithArgs(Editor::RailSwitchGroupButton, zone, leftX, topY, railSwitchGroup)
 
-//////////////////////////////// Editor::EditingMutexLocker ////////////////////////////////
-mutex Editor::EditingMutexLocker::editingMutex;
-Editor::EditingMutexLocker::EditingMutexLocker() {
-	if (isActive)
-		editingMutex.lock();
-}
-Editor::EditingMutexLocker::~EditingMutexLocker() {
-	if (isActive)
-		editingMutex.unlock();
-}
 
 //////////////////////////////// Editor::RGB ////////////////////////////////
 Editor::RGB::RGB(float pRed, float pGreen, float pBlue)
@@ -891,7 +881,6 @@ void Editor::getMouseMapXY(int screenLeftWorldX, int screenTopWorldY, int* outMa
 	*outMapY = (scaledMouseY + screenTopWorldY) / MapState::tileSize;
 }
 void Editor::handleClick(SDL_MouseButtonEvent& clickEvent, bool isDrag, EntityState* camera, int ticksTime) {
-	EditingMutexLocker editingMutexLocker;
 	if (!isDrag)
 		lastMouseDragAction = MouseDragAction::None;
 
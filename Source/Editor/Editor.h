@@ -21,17 +21,6 @@ private:
 		AddRemoveSwitch,
 		AddRemoveResetSwitch,
 	};
-public:
-	//Should only be allocated on the stack
-	class EditingMutexLocker {
-	private:
-		static mutex editingMutex;
-
-	public:
-		EditingMutexLocker();
-		virtual ~EditingMutexLocker();
-	};
-private:
 	//Should only be allocated within an object, on the stack, or as a static object
 	class RGB {
 	public:
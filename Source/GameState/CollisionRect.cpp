@@ -1,22 +1,24 @@
 #include "CollisionRect.h"
 
-CollisionRect::CollisionRect(objCounterParameters())
-: PooledReferenceCounter(objCounterArguments())
-, left(0)
+CollisionRect::CollisionRect()
+: left(0)
 , top(0)
 , right(0)
 , bottom(0) {
 }
+CollisionRect::CollisionRect(float pLeft, float pTop, float pRight, float pBottom)
+: left(pLeft)
+, top(pTop)
+, right(pRight)
+, bottom(pBottom) {
+}
 CollisionRect::~CollisionRect() {}
-CollisionRect* CollisionRect::produce(objCounterParametersComma() float pLeft, float pTop, float pRight, float pBottom) {
-	initializeWithNewFromPool(c, CollisionRect)
-	c->left = pLeft;
-	c->top = pTop;
-	c->right = pRight;
-	c->bottom = pBottom;
-	return c;
+void CollisionRect::set(float pLeft, float pTop, float pRight, float pBottom) {
+	left = pLeft;
+	top = pTop;
+	right = pRight;
+	bottom = pBottom;
 }
-pooledReferenceCounterDefineRelease(CollisionRect)
 bool CollisionRect::intersects(CollisionRect* other) {
 	return left < other->right && other->left < right && top < other->bottom && other->top < bottom;
 }
@@ -1,21 +1,22 @@
-#include "Util/PooledReferenceCounter.h"
+#ifndef COLLISION_RECT_H
+#define COLLISION_RECT_H
+#include "General/General.h"
 
-#define newCollisionRect(left, top, right, bottom) produceWithArgs(CollisionRect, left, top, right, bottom)
-
-class CollisionRect: public PooledReferenceCounter {
+//Should only be allocated within an object, on the stack, or as a static object
+class CollisionRect {
 public:
 	float left;
 	float top;
 	float right;
 	float bottom;
 
-	CollisionRect(objCounterParameters());
+	CollisionRect();
+	CollisionRect(float pLeft, float pTop, float pRight, float pBottom);
 	virtual ~CollisionRect();
 
-	//initialize and return a CollisionRect
-	static CollisionRect* produce(objCounterParametersComma() float pLeft, float pTop, float pRight, float pBottom);
-	//release a reference to this CollisionRect and return it to the pool if applicable
-	virtual void release();
+	//set all the bounds of this CollisionRect
+	void set(float pLeft, float pTop, float pRight, float pBottom);
 	//check if this CollisionRect has any overlap with the other CollisionRect
 	bool intersects(CollisionRect* other);
 };
+#endif
@@ -1,10 +1,118 @@
 #include "DynamicValue.h"
 
 //////////////////////////////// DynamicValue ////////////////////////////////
+//a quiet NaN for both the ticks elapsed and value, so that no evaluation matches it
+const unsigned long long noLastEvaluation = 0x7FC000007FC00000ULL;
 DynamicValue::DynamicValue(objCounterParameters())
-: PooledReferenceCounter(objCounterArguments()) {
+: PooledReferenceCounter(objCounterArguments())
+, program()
+, programData()
+, lastEvaluation(noLastEvaluation) {
 }
 DynamicValue::~DynamicValue() {}
+void DynamicValue::compile() {
+	program.clear();
+	programData.clear();
+	appendInstructions(&program, &programData);
+	lastEvaluation.store(noLastEvaluation, memory_order_relaxed);
+}
+DynamicValue::Instruction DynamicValue::newInstruction(Instruction::Type type) {
+	Instruction instruction;
+	instruction.type = type;
+	instruction.index = 0;
+	instruction.count = 0;
+	for (float& value : instruction.values)
+		value = 0.0f;
+	return instruction;
+}
+float DynamicValue::getValue(float ticksElapsed) {
+	unsigned int ticksElapsedBits;
+	memcpy(&ticksElapsedBits, &ticksElapsed, sizeof(ticksElapsedBits));
+	unsigned long long last = lastEvaluation.load(memory_order_relaxed);
+	float value;
+	if ((unsigned int)(last >> 32) == ticksElapsedBits) {
+		unsigned int valueBits = (unsigned int)last;
+		memcpy(&value, &valueBits, sizeof(value));
+		return value;
+	}
+	value = evaluate(0, ticksElapsed);
+	unsigned int valueBits;
+	memcpy(&valueBits, &value, sizeof(valueBits));
+	lastEvaluation.store(((unsigned long long)ticksElapsedBits << 32) | valueBits, memory_order_relaxed);
+	return value;
+}
+float DynamicValue::evaluate(int instructionIndex, float ticksElapsed) {
+	while (true) {
+		Instruction& instruction = program[instructionIndex];
+		switch (instruction.type) {
+			case Instruction::Type::Constant:
+				return instruction.values[0];
+			case Instruction::Type::CompositeQuartic: {
+				float ticksElapsedSquared = ticksElapsed * ticksElapsed;
+				float ticksElapsedCubed = ticksElapsedSquared * ticksElapsed;
+				return instruction.values[0]
+					+ instruction.values[1] * ticksElapsed
+					+ instruction.values[2] * ticksElapsedSquared
+					+ instruction.values[3] * ticksElapsedCubed
+					+ instruction.values[4] * ticksElapsedCubed * ticksElapsed;
+			}
+			case Instruction::Type::Exponential:
+				return powf(instruction.values[0], ticksElapsed / instruction.values[1]);
+			case Instruction::Type::LinearInterpolated: {
+				//values are stored as (value, ticks time) pairs
+				float* valuesAtTimes = &programData[instruction.index];
+				//use the last value if we're after the last ticks time
+				int highIndex = (instruction.count - 1) * 2;
+				if (ticksElapsed >= valuesAtTimes[highIndex + 1])
+					return valuesAtTimes[highIndex];
+				//use the first value if we're before the first ticks time
+				int lowIndex = 0;
+				if (ticksElapsed <= valuesAtTimes[lowIndex + 1])
+					return valuesAtTimes[lowIndex];
+				//find which values we're between
+				while (lowIndex < highIndex - 2) {
+					int midIndex = (lowIndex + highIndex) / 4 * 2;
+					if (ticksElapsed >= valuesAtTimes[midIndex + 1])
+						lowIndex = midIndex;
+					else
+						highIndex = midIndex;
+				}
+				float lowValue = valuesAtTimes[lowIndex];
+				float lowAtTicksTime = valuesAtTimes[lowIndex + 1];
+				float highValue = valuesAtTimes[highIndex];
+				float highAtTicksTime = valuesAtTimes[highIndex + 1];
+				float interValueDuration = highAtTicksTime - lowAtTicksTime;
+				float lowValuePart = lowValue * (highAtTicksTime - ticksElapsed) / interValueDuration;
+				float highValuePart = highValue * (ticksElapsed - lowAtTicksTime) / interValueDuration;
+				return highValuePart + lowValuePart;
+			}
+			case Instruction::Type::Piecewise: {
+				//find the active piece, then continue with its value
+				int activePieceIndex = instruction.index;
+				int futurePieceIndex = instruction.index + instruction.count;
+				while (activePieceIndex < futurePieceIndex - 1) {
+					int midIndex = (activePieceIndex + futurePieceIndex) / 2;
+					if (program[midIndex].values[0] > ticksElapsed)
+						futurePieceIndex = midIndex;
+					else
+						activePieceIndex = midIndex;
+				}
+				Instruction& activePiece = program[activePieceIndex];
+				ticksElapsed -= activePiece.values[0];
+				instructionIndex = activePiece.index;
+				break;
+			}
+			case Instruction::Type::TimeFunction:
+				//the time function directly follows this instruction, then continue with the inner value at that time
+				ticksElapsed = evaluate(instructionIndex + 1, ticksElapsed);
+				instructionIndex = instruction.index;
+				break;
+			//pieces are only read by their Piecewise instruction
+			default:
+				return 0.0f;
+		}
+	}
+}
 
 //////////////////////////////// ConstantValue ////////////////////////////////
 ConstantValue::ConstantValue(objCounterParameters())
@@ -15,14 +123,17 @@ ConstantValue::~ConstantValue() {}
 ConstantValue* ConstantValue::produce(objCounterParametersComma() float pValue) {
 	initializeWithNewFromPool(c, ConstantValue)
 	c->value = pValue;
+	c->compile();
 	return c;
 }
 pooledReferenceCounterDefineRelease(ConstantValue)
 DynamicValue* ConstantValue::copyWithConstantValue(float pConstantValue) {
 	return newConstantValue(pConstantValue);
 }
-float ConstantValue::getValue(float ticksElapsed) {
-	return value;
+void ConstantValue::appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData) {
+	Instruction instruction = newInstruction(Instruction::Type::Constant);
+	instruction.values[0] = value;
+	outProgram->push_back(instruction);
 }
 
 //////////////////////////////// CompositeQuarticValue ////////////////////////////////
@@ -49,6 +160,7 @@ CompositeQuarticValue* CompositeQuarticValue::produce(
 	c->quadraticValuePerTick = pQuadraticValuePerTick;
 	c->cubicValuePerTick = pCubicValuePerTick;
 	c->quarticValuePerTick = pQuarticValuePerTick;
+	c->compile();
 	return c;
 }
 pooledReferenceCounterDefineRelease(CompositeQuarticValue)
@@ -56,14 +168,14 @@ DynamicValue* CompositeQuarticValue::copyWithConstantValue(float pConstantValue)
 	return newCompositeQuarticValue(
 		pConstantValue, linearValuePerTick, quadraticValuePerTick, cubicValuePerTick, quarticValuePerTick);
 }
-float CompositeQuarticValue::getValue(float ticksElapsed) {
-	float ticksElapsedSquared = ticksElapsed * ticksElapsed;
-	float ticksElapsedCubed = ticksElapsedSquared * ticksElapsed;
-	return constantValue
-		+ linearValuePerTick * ticksElapsed
-		+ quadraticValuePerTick * ticksElapsedSquared
-		+ cubicValuePerTick * ticksElapsedCubed
-		+ quarticValuePerTick * ticksElapsedCubed * ticksElapsed;
+void CompositeQuarticValue::appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData) {
+	Instruction instruction = newInstruction(Instruction::Type::CompositeQuartic);
+	instruction.values[0] = constantValue;
+	instruction.values[1] = linearValuePerTick;
+	instruction.values[2] = quadraticValuePerTick;
+	instruction.values[3] = cubicValuePerTick;
+	instruction.values[4] = quarticValuePerTick;
+	outProgram->push_back(instruction);
 }
 PiecewiseValue* CompositeQuarticValue::cubicInterpolation(float targetValue, float ticksDuration) {
 	//vy = at(t-1) = at^2-at   (a < 0)
@@ -92,6 +204,7 @@ ExponentialValue* ExponentialValue::produce(objCounterParametersComma() float pB
 	initializeWithNewFromPool(e, ExponentialValue)
 	e->baseExponent = pBaseExponent;
 	e->baseDuration = pBaseDuration;
+	e->compile();
 	return e;
 }
 pooledReferenceCounterDefineRelease(ExponentialValue)
@@ -99,8 +212,11 @@ DynamicValue* ExponentialValue::copyWithConstantValue(float pConstantValue) {
 	//TODO not supported, needs a SumValue because the value at 0 is always 1
 	return this;
 }
-float ExponentialValue::getValue(float ticksElapsed) {
-	return powf(baseExponent, ticksElapsed / baseDuration);
+void ExponentialValue::appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData) {
+	Instruction instruction = newInstruction(Instruction::Type::Exponential);
+	instruction.values[0] = baseExponent;
+	instruction.values[1] = baseDuration;
+	outProgram->push_back(instruction);
 }
 
 //////////////////////////////// LinearInterpolatedValue::ValueAtTime ////////////////////////////////
@@ -119,6 +235,7 @@ LinearInterpolatedValue::~LinearInterpolatedValue() {}
 LinearInterpolatedValue* LinearInterpolatedValue::produce(objCounterParametersComma() vector<ValueAtTime> valuesAtTimes) {
 	initializeWithNewFromPool(l, LinearInterpolatedValue)
 	l->valuesAtTimes = valuesAtTimes;
+	l->compile();
 	return l;
 }
 pooledReferenceCounterDefineRelease(LinearInterpolatedValue)
@@ -127,35 +244,18 @@ DynamicValue* LinearInterpolatedValue::copyWithConstantValue(float pConstantValu
 	float shift = pConstantValue - valuesAtTimes.front().getValue();
 	for (ValueAtTime valueAtTime : valuesAtTimes)
 		copyValue->valuesAtTimes.push_back(ValueAtTime(valueAtTime.getValue() + shift, valueAtTime.getAtTicksTime()));
+	copyValue->compile();
 	return copyValue;
 }
-float LinearInterpolatedValue::getValue(float ticksElapsed) {
-	//use the last value if we're after the last ticks time
-	int highIndex = (int)valuesAtTimes.size() - 1;
-	ValueAtTime* highValueAtTime = &valuesAtTimes[highIndex];
-	if (ticksElapsed >= highValueAtTime->getAtTicksTime())
-		return highValueAtTime->getValue();
-	//use the first value if we're before the first ticks time
-	int lowIndex = 0;
-	ValueAtTime* lowValueAtTime = &valuesAtTimes[lowIndex];
-	if (ticksElapsed <= lowValueAtTime->getAtTicksTime())
-		return lowValueAtTime->getValue();
-	//find which values we're between
-	while (lowIndex < highIndex - 1) {
-		int midIndex = (lowIndex + highIndex) / 2;
-		ValueAtTime* midValueAtTime = &valuesAtTimes[midIndex];
-		if (ticksElapsed >= midValueAtTime->getAtTicksTime()) {
-			lowIndex = midIndex;
-			lowValueAtTime = midValueAtTime;
-		} else {
-			highIndex = midIndex;
-			highValueAtTime = midValueAtTime;
-		}
+void LinearInterpolatedValue::appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData) {
+	Instruction instruction = newInstruction(Instruction::Type::LinearInterpolated);
+	instruction.index = (int)outProgramData->size();
+	instruction.count = (int)valuesAtTimes.size();
+	outProgram->push_back(instruction);
+	for (ValueAtTime& valueAtTime : valuesAtTimes) {
+		outProgramData->push_back(valueAtTime.getValue());
+		outProgramData->push_back(valueAtTime.getAtTicksTime());
 	}
-	float interValueDuration = (float)(highValueAtTime->getAtTicksTime() - lowValueAtTime->getAtTicksTime());
-	float lowValuePart = lowValueAtTime->getValue() * (highValueAtTime->getAtTicksTime() - ticksElapsed) / interValueDuration;
-	float highValuePart = highValueAtTime->getValue() * (ticksElapsed - lowValueAtTime->getAtTicksTime()) / interValueDuration;
-	return highValuePart + lowValuePart;
 }
 
 //////////////////////////////// PiecewiseValue::ValueAtTime ////////////////////////////////
@@ -174,6 +274,7 @@ PiecewiseValue::~PiecewiseValue() {}
 PiecewiseValue* PiecewiseValue::produce(objCounterParametersComma() vector<ValueAtTime> valuesAtTimes) {
 	initializeWithNewFromPool(p, PiecewiseValue)
 	p->valuesAtTimes = valuesAtTimes;
+	p->compile();
 	return p;
 }
 pooledReferenceCounterDefineRelease(PiecewiseValue)
@@ -188,21 +289,24 @@ DynamicValue* PiecewiseValue::copyWithConstantValue(float pConstantValue) {
 		copyValue->valuesAtTimes.push_back(
 			ValueAtTime(pieceValue->copyWithConstantValue(pieceValue->getValue(0) + shift), valueAtTime.getAtTicksTime()));
 	}
+	copyValue->compile();
 	return copyValue;
 }
-float PiecewiseValue::getValue(float ticksElapsed) {
-	int activeValueIndex = 0;
-	int futureValueIndex = (int)valuesAtTimes.size();
-	while (activeValueIndex < futureValueIndex - 1) {
-		int midIndex = (activeValueIndex + futureValueIndex) / 2;
-		ValueAtTime* midValueAtTime = &valuesAtTimes[midIndex];
-		if (midValueAtTime->getAtTicksTime() > ticksElapsed)
-			futureValueIndex = midIndex;
-		else
-			activeValueIndex = midIndex;
+void PiecewiseValue::appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData) {
+	Instruction instruction = newInstruction(Instruction::Type::Piecewise);
+	instruction.index = (int)outProgram->size() + 1;
+	instruction.count = (int)valuesAtTimes.size();
+	outProgram->push_back(instruction);
+	//the pieces go first so that they can be searched, followed by each of their values
+	for (ValueAtTime& valueAtTime : valuesAtTimes) {
+		Instruction piece = newInstruction(Instruction::Type::Piece);
+		piece.values[0] = valueAtTime.getAtTicksTime();
+		outProgram->push_back(piece);
+	}
+	for (int i = 0; i < (int)valuesAtTimes.size(); i++) {
+		(*outProgram)[instruction.index + i].index = (int)outProgram->size();
+		valuesAtTimes[i].getValue()->appendInstructions(outProgram, outProgramData);
 	}
-	ValueAtTime& activeValueAtTime = valuesAtTimes[activeValueIndex];
-	return activeValueAtTime.getValue()->getValue(ticksElapsed - activeValueAtTime.getAtTicksTime());
 }
 
 //////////////////////////////// TimeFunctionValue ////////////////////////////////
@@ -218,6 +322,7 @@ TimeFunctionValue* TimeFunctionValue::produce(
 	initializeWithNewFromPool(t, TimeFunctionValue)
 	t->innerValue.set(pInnerValue);
 	t->timeFunction.set(pTimeFunction);
+	t->compile();
 	return t;
 }
 pooledReferenceCounterDefineRelease(TimeFunctionValue)
@@ -229,6 +334,10 @@ DynamicValue* TimeFunctionValue::copyWithConstantValue(float pConstantValue) {
 	//TODO not supported, needs a SumValue because the value at 0 is not controlled by this value
 	return this;
 }
-float TimeFunctionValue::getValue(float ticksElapsed) {
-	return innerValue.get()->getValue(timeFunction.get()->getValue(ticksElapsed));
+void TimeFunctionValue::appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData) {
+	int instructionIndex = (int)outProgram->size();
+	outProgram->push_back(newInstruction(Instruction::Type::TimeFunction));
+	timeFunction.get()->appendInstructions(outProgram, outProgramData);
+	(*outProgram)[instructionIndex].index = (int)outProgram->size();
+	innerValue.get()->appendInstructions(outProgram, outProgramData);
 }
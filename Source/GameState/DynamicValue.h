@@ -13,15 +13,66 @@
 class PiecewiseValue;
 
 //each DynamicValue is only held in one place at a time
+//a DynamicValue does not change once it's produced, so when it's produced, its whole tree of values is compiled into a flat
+//	program of instructions, which is what gets evaluated
 class DynamicValue: public PooledReferenceCounter {
+public:
+	//a plain tagged instruction, to be stored contiguously and evaluated without any virtual calls
+	//Should only be allocated within an object, on the stack, or as a static object
+	class Instruction {
+	public:
+		enum class Type: unsigned char {
+			Constant,
+			CompositeQuartic,
+			Exponential,
+			LinearInterpolated,
+			Piecewise,
+			Piece,
+			TimeFunction,
+		};
+
+		Type type;
+		//LinearInterpolated: the index of its first (value, ticks time) pair in the program data
+		//Piecewise: the index of its first Piece instruction
+		//Piece: the index of the first instruction of its value
+		//TimeFunction: the index of the first instruction of its inner value; its time function begins at the next instruction
+		int index;
+		//LinearInterpolated: the number of (value, ticks time) pairs
+		//Piecewise: the number of Piece instructions
+		int count;
+		//Constant: the value
+		//CompositeQuartic: the constant, linear, quadratic, cubic, and quartic values per tick
+		//Exponential: the base exponent and base duration
+		//Piece: the ticks time that it starts at
+		float values[5];
+	};
+
+private:
+	vector<Instruction> program;
+	vector<float> programData;
+	//the bits of the last ticks elapsed that this was evaluated at, followed by the bits of the value it had
+	//both the update and render threads evaluate values, so they're packed together to be read and written atomically
+	atomic<unsigned long long> lastEvaluation;
+
 public:
 	DynamicValue(objCounterParameters());
 	virtual ~DynamicValue();
 
+protected:
+	//build the program for this value from its current state
+	void compile();
+	//return a new Instruction of the given type for the program, with no index, count, or values
+	static Instruction newInstruction(Instruction::Type type);
+public:
+	//add the instructions for this value to the end of the given program, and any data they use to the end of the given data
+	virtual void appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData) = 0;
 	//copy this DynamicValue such that at 0 ticks elapsed, it equals the provided constant value
 	virtual DynamicValue* copyWithConstantValue(float pConstantValue) = 0;
-	//return the value after the given amount of time has elapsed
-	virtual float getValue(float ticksElapsed) = 0;
+	//return the value after the given amount of time has elapsed, reusing the last value if it's for the same time
+	float getValue(float ticksElapsed);
+private:
+	//evaluate the program starting at the given instruction
+	float evaluate(int instructionIndex, float ticksElapsed);
 };
 class ConstantValue: public DynamicValue {
 private:
@@ -37,8 +88,8 @@ public:
 	virtual void release();
 	//return a new ConstantValue with the provided value
 	virtual DynamicValue* copyWithConstantValue(float pConstantValue);
-	//get the value at the given time
-	virtual float getValue(float ticksElapsed);
+	//add the instructions for this value to the given program
+	virtual void appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData);
 };
 class CompositeQuarticValue: public DynamicValue {
 private:
@@ -64,8 +115,8 @@ public:
 	virtual void release();
 	//set the constant value to the provided value
 	virtual DynamicValue* copyWithConstantValue(float pConstantValue);
-	//get the value at the given time
-	virtual float getValue(float ticksElapsed);
+	//add the instructions for this value to the given program
+	virtual void appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData);
 	//return a CompositeQuarticValue that follows a curve from (0, 0) to (1, 1) with 0 slope at (0, 0) and (1, 1), wrapped in a
 	//	PiecewiseValue that clamps it at y=1 past x=1
 	static PiecewiseValue* cubicInterpolation(float targetValue, float ticksDuration);
@@ -85,8 +136,8 @@ public:
 	virtual void release();
 	//return a new value shifted so that it's the given value at time 0
 	virtual DynamicValue* copyWithConstantValue(float pConstantValue);
-	//get the value at the given time
-	virtual float getValue(float ticksElapsed);
+	//add the instructions for this value to the given program
+	virtual void appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData);
 };
 class LinearInterpolatedValue: public DynamicValue {
 public:
@@ -118,9 +169,8 @@ public:
 	//return a new value with all the values shifted so that it's the given value at time 0
 	//assumes there is at least one value
 	virtual DynamicValue* copyWithConstantValue(float pConstantValue);
-	//get the value at the given time
-	//assumes there is at least one value
-	virtual float getValue(float ticksElapsed);
+	//add the instructions for this value to the given program
+	virtual void appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData);
 };
 class PiecewiseValue: public DynamicValue {
 public:
@@ -156,9 +206,8 @@ public:
 	//return a new value with all the values shifted so that it's the given value at time 0
 	//assumes there is at least one value
 	virtual DynamicValue* copyWithConstantValue(float pConstantValue);
-	//get the value at the given time
-	//assumes there is at least one value
-	virtual float getValue(float ticksElapsed);
+	//add the instructions for this value to the given program
+	virtual void appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData);
 };
 class TimeFunctionValue: public DynamicValue {
 private:
@@ -179,6 +228,6 @@ protected:
 public:
 	//return a new value shifted so that it's the given value at time 0
 	virtual DynamicValue* copyWithConstantValue(float pConstantValue);
-	//get the value at the given time
-	virtual float getValue(float ticksElapsed);
+	//add the instructions for this value to the given program
+	virtual void appendInstructions(vector<Instruction>* outProgram, vector<float>* outProgramData);
 };
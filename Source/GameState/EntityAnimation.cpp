@@ -352,7 +352,18 @@ EntityAnimation* EntityAnimation::produce(
 {
 	initializeWithNewFromPool(e, EntityAnimation)
 	e->lastUpdateTicksTime = pStartTicksTime;
-	e->components = *pComponents;
+	e->components.swap(*pComponents);
+	e->nextComponentIndex = 0;
+	return e;
+}
+EntityAnimation* EntityAnimation::produce(
+	objCounterParametersComma() int pStartTicksTime, initializer_list<ReferenceCounterBorrow<Component>> pComponents)
+{
+	initializeWithNewFromPool(e, EntityAnimation)
+	e->lastUpdateTicksTime = pStartTicksTime;
+	e->components.reserve(pComponents.size());
+	for (const ReferenceCounterBorrow<Component>& component : pComponents)
+		e->components.push_back(component.get());
 	e->nextComponentIndex = 0;
 	return e;
 }
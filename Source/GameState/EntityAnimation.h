@@ -320,11 +320,16 @@ public:
 	EntityAnimation(objCounterParameters());
 	virtual ~EntityAnimation();
 
-	//initialize and return an EntityAnimation
+	//initialize and return an EntityAnimation, taking the components out of the given vector
 	static EntityAnimation* produce(
 		objCounterParametersComma()
 		int pStartTicksTime,
 		vector<ReferenceCounterHolder<EntityAnimationTypes::Component>>* pComponents);
+	//initialize and return an EntityAnimation, retaining each of the given components once
+	static EntityAnimation* produce(
+		objCounterParametersComma()
+		int pStartTicksTime,
+		initializer_list<ReferenceCounterBorrow<EntityAnimationTypes::Component>> pComponents);
 	//release a reference to this EntityAnimation and return it to the pool if applicable
 	virtual void release();
 protected:
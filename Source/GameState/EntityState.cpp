@@ -2,16 +2,13 @@
 #include "GameState/DynamicValue.h"
 #include "GameState/EntityAnimation.h"
 #include "GameState/GameState.h"
+#include "GameState/MapState/MapState.h"
 #include "Sprites/SpriteAnimation.h"
 #include "Sprites/SpriteRegistry.h"
 #include "Sprites/SpriteSheet.h"
 #include "Util/Config.h"
 
 //////////////////////////////// EntityState ////////////////////////////////
-#ifdef PIXELLATED_ZOOM
-	GLuint EntityState::postZoomFrameBufferId = 0;
-	GLuint EntityState::postZoomRenderBufferId = 0;
-#endif
 GLuint EntityState::preZoomFrameBufferId = 0;
 GLuint EntityState::preZoomTextureId = 0;
 EntityState::EntityState(objCounterParameters())
@@ -46,20 +43,6 @@ void EntityState::prepareReturnToPool() {
 	zoom.clear();
 }
 void EntityState::setupZoomFrameBuffers() {
-	#ifdef PIXELLATED_ZOOM
-		//set up the post-zoom frame buffer, which uses a render buffer
-		glGenFramebuffers(1, &postZoomFrameBufferId);
-		glBindFramebuffer(GL_FRAMEBUFFER, postZoomFrameBufferId);
-		glGenRenderbuffers(1, &postZoomRenderBufferId);
-		glBindRenderbuffer(GL_RENDERBUFFER, postZoomRenderBufferId);
-		glRenderbufferStorage(
-			GL_RENDERBUFFER, GL_RGB8, (GLsizei)Config::windowScreenWidth, (GLsizei)Config::windowScreenHeight);
-		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, postZoomRenderBufferId);
-		#ifdef DEBUG
-			Opengl::checkAndLogFrameBufferStatus(GL_FRAMEBUFFER, "postZoomFrameBuffer");
-		#endif
-	#endif
-
 	//set up the pre-zoom frame buffer, which uses a texture
 	glGenFramebuffers(1, &preZoomFrameBufferId);
 	glBindFramebuffer(GL_FRAMEBUFFER, preZoomFrameBufferId);
@@ -107,9 +90,6 @@ float EntityState::getRenderCenterScreenYFromWorldY(float worldY, EntityState* c
 	int screenYOffset = (int)worldY - (int)camera->getRenderCenterWorldY(ticksTime);
 	return (float)screenYOffset + (float)Config::gameScreenHeight * 0.5f;
 }
-int EntityState::getAnimationTicksDuration() {
-	return entityAnimation.get() != nullptr ? entityAnimation.get()->getTotalTicksDuration() : 0;
-}
 SpriteDirection EntityState::getSpriteDirection(float pX, float pY) {
 	return abs(pY) >= abs(pX)
 		? pY >= 0 ? SpriteDirection::Down : SpriteDirection::Up
@@ -158,22 +138,22 @@ float EntityState::renderBeginZoom(int ticksTime) {
 	float zoomValue = zoom.get()->getValue((float)(ticksTime - lastUpdateTicksTime));
 	if (zoomValue == 1)
 		return 1;
+	SpriteSheet::callOpenGLFunction(&bindPreZoomFrameBuffer, zoomValue);
+	return zoomValue;
+}
+void EntityState::bindPreZoomFrameBuffer(float zoomValue) {
 	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, preZoomFrameBufferId);
 	Opengl::orientRenderTarget(false);
 	glViewport(0, 0, (GLsizei)Config::windowScreenWidth, (GLsizei)Config::windowScreenHeight);
-	return zoomValue;
 }
 void EntityState::renderEndZoom(float zoomValue) {
 	if (zoomValue == 1)
 		return;
-
-	//render the image zoomed
-	#ifdef PIXELLATED_ZOOM
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, postZoomFrameBufferId);
-	#else
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-		glViewport(0, 0, (GLint)Config::windowDisplayWidth, (GLint)Config::windowDisplayHeight);
-	#endif
+	SpriteSheet::callOpenGLFunction(&drawZoomedFrameBuffer, zoomValue);
+}
+void EntityState::drawZoomedFrameBuffer(float zoomValue) {
+	//render the image zoomed into the native-resolution frame, which keeps it pixellated
+	Opengl::bindNativeFrameBuffer();
 	Opengl::orientRenderTarget(true);
 	float topLeftBorder = (zoomValue - 1.0f) / zoomValue * 0.5f;
 	float bottomRightBorder = 1.0f - topLeftBorder;
@@ -190,20 +170,6 @@ void EntityState::renderEndZoom(float zoomValue) {
 	glVertex2i(0, (GLint)Config::windowScreenHeight);
 	glEnd();
 	glDisable(GL_TEXTURE_2D);
-
-	#ifdef PIXELLATED_ZOOM
-		//render the zoomed image to the screen
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, postZoomFrameBufferId);
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-		glViewport(0, 0, (GLint)Config::windowDisplayWidth, (GLint)Config::windowDisplayHeight);
-		glBlitFramebuffer(
-			//source
-			0, 0, (GLint)Config::windowScreenWidth, (GLint)Config::windowScreenHeight,
-			//destination
-			0, 0, (GLint)Config::windowDisplayWidth, (GLint)Config::windowDisplayHeight,
-			GL_COLOR_BUFFER_BIT,
-			GL_NEAREST);
-	#endif
 }
 
 //////////////////////////////// DynamicCameraAnchor ////////////////////////////////
@@ -310,62 +276,144 @@ void DynamicCameraAnchor::render(int ticksTime) {
 //////////////////////////////// Particle ////////////////////////////////
 Particle::Particle(objCounterParameters())
 : EntityState(objCounterArguments())
-, spriteAnimation(nullptr)
-, spriteAnimationStartTicksTime(0)
-, spriteDirection(SpriteDirection::Right)
-, r(0)
-, g(0)
-, b(0)
-, isAbovePlayer(false) {
-}
-Particle::~Particle() {
-	//don't delete the sprite animation, SpriteRegistry owns it
-}
-Particle* Particle::produce(objCounterParametersComma() float pX, float pY, float pR, float pG, float pB, bool pIsAbovePlayer) {
+, buffer(nullptr)
+, index(0) {
+}
+Particle::~Particle() {}
+Particle* Particle::produce(objCounterParametersComma() ParticleBuffer* pBuffer) {
 	initializeWithNewFromPool(p, Particle)
-	p->initEntityState(pX, pY, 1.0f);
-	p->spriteAnimation = nullptr;
-	p->r = pR;
-	p->g = pG;
-	p->b = pB;
-	p->isAbovePlayer = pIsAbovePlayer;
+	p->buffer = pBuffer;
+	p->index = 0;
 	return p;
 }
-void Particle::copyParticle(Particle* other) {
-	copyEntityState(other);
-	setSpriteAnimation(other->spriteAnimation, other->spriteAnimationStartTicksTime);
-	setDirection(other->spriteDirection);
-	r = other->r;
-	g = other->g;
-	b = other->b;
-	isAbovePlayer = other->isAbovePlayer;
-}
 pooledReferenceCounterDefineRelease(Particle)
 void Particle::setSpriteAnimation(SpriteAnimation* pSpriteAnimation, int pSpriteAnimationStartTicksTime) {
-	spriteAnimation = pSpriteAnimation;
-	spriteAnimationStartTicksTime = pSpriteAnimationStartTicksTime;
+	buffer->spriteAnimations[index] = pSpriteAnimation;
+	buffer->spriteAnimationStartTicksTimes[index] = pSpriteAnimationStartTicksTime;
 }
 void Particle::setDirection(SpriteDirection pSpriteDirection) {
-	spriteDirection = pSpriteDirection;
+	buffer->spriteDirections[index] = pSpriteDirection;
 }
-bool Particle::updateWithPreviousParticle(Particle* prev, int ticksTime) {
-	copyParticle(prev);
-	//if we have an entity animation, update with that instead
-	if (prev->entityAnimation.get() != nullptr) {
-		if (entityAnimation.get()->update(this, ticksTime))
-			return true;
-		entityAnimation.clear();
+
+//////////////////////////////// ParticleBuffer ////////////////////////////////
+ParticleBuffer::ParticleBuffer()
+: centerXs()
+, centerYs()
+, reds()
+, greens()
+, blues()
+, isAbovePlayers()
+, spriteAnimations()
+, spriteAnimationStartTicksTimes()
+, spriteDirections()
+, entityAnimations()
+, particleView(nullptr) {
+}
+ParticleBuffer::~ParticleBuffer() {
+	//don't delete the sprite animations, SpriteRegistry owns them
+}
+void ParticleBuffer::clear() {
+	resize(0);
+	particleView.clear();
+}
+void ParticleBuffer::resize(int count) {
+	centerXs.resize(count);
+	centerYs.resize(count);
+	reds.resize(count);
+	greens.resize(count);
+	blues.resize(count);
+	isAbovePlayers.resize(count);
+	spriteAnimations.resize(count);
+	spriteAnimationStartTicksTimes.resize(count);
+	spriteDirections.resize(count);
+	entityAnimations.resize(count, nullptr);
+}
+Particle* ParticleBuffer::getParticleView(int index) {
+	if (particleView.get() == nullptr)
+		particleView.set(newParticle(this));
+	particleView.get()->setIndex(index);
+	return particleView.get();
+}
+EntityAnimation* ParticleBuffer::addParticle(
+	float centerX,
+	float centerY,
+	float r,
+	float g,
+	float b,
+	bool isAbovePlayer,
+	initializer_list<ReferenceCounterBorrow<EntityAnimationTypes::Component>> components,
+	int ticksTime)
+{
+	int index = (int)centerXs.size();
+	resize(index + 1);
+	centerXs[index] = centerX;
+	centerYs[index] = centerY;
+	reds[index] = r;
+	greens[index] = g;
+	blues[index] = b;
+	isAbovePlayers[index] = isAbovePlayer;
+	spriteAnimations[index] = nullptr;
+	spriteAnimationStartTicksTimes[index] = 0;
+	spriteDirections[index] = SpriteDirection::Right;
+	EntityAnimation* entityAnimation = newEntityAnimation(ticksTime, components);
+	entityAnimations[index].set(entityAnimation);
+	//update it once to get it started
+	entityAnimation->update(getParticleView(index), ticksTime);
+	return entityAnimation;
+}
+void ParticleBuffer::updateWithPreviousParticleBuffer(ParticleBuffer* prev, int ticksTime) {
+	int prevParticlesCount = (int)prev->centerXs.size();
+	resize(prevParticlesCount);
+	int keptParticlesCount = 0;
+	for (int i = 0; i < prevParticlesCount; i++) {
+		int index = keptParticlesCount;
+		centerXs[index] = prev->centerXs[i];
+		centerYs[index] = prev->centerYs[i];
+		reds[index] = prev->reds[i];
+		greens[index] = prev->greens[i];
+		blues[index] = prev->blues[i];
+		isAbovePlayers[index] = prev->isAbovePlayers[i];
+		spriteAnimations[index] = prev->spriteAnimations[i];
+		spriteAnimationStartTicksTimes[index] = prev->spriteAnimationStartTicksTimes[i];
+		spriteDirections[index] = prev->spriteDirections[i];
+		EntityAnimation* entityAnimation = prev->entityAnimations[i].get();
+		entityAnimations[index].set(entityAnimation);
+		//the next particle overwrites this one if its animation is finished
+		if (entityAnimation->update(getParticleView(index), ticksTime))
+			keptParticlesCount++;
 	}
-	return false;
-}
-void Particle::render(EntityState* camera, int ticksTime) {
-	if (spriteAnimation == nullptr)
-		return;
+	resize(keptParticlesCount);
+}
+void ParticleBuffer::render(EntityState* camera, bool renderAbovePlayer, int ticksTime) {
+	//convert the camera position to ints first to align with the map, the same as getRenderCenterScreenXFromWorldX()
+	int screenXOffset = -(int)camera->getRenderCenterWorldX(ticksTime);
+	int screenYOffset = -(int)camera->getRenderCenterWorldY(ticksTime);
+	float halfScreenWidth = (float)Config::gameScreenWidth * 0.5f;
+	float halfScreenHeight = (float)Config::gameScreenHeight * 0.5f;
+	for (int i = 0; i < (int)centerXs.size(); i++) {
+		SpriteAnimation* spriteAnimation = spriteAnimations[i];
+		if (spriteAnimation == nullptr || isAbovePlayers[i] != renderAbovePlayer)
+			continue;
 
-	(spriteAnimation->getSprite()->*SpriteSheet::setSpriteColor)((GLfloat)r, (GLfloat)g, (GLfloat)b, 1.0f);
-	float renderCenterX = getRenderCenterScreenX(camera,  ticksTime);
-	float renderCenterY = getRenderCenterScreenY(camera,  ticksTime);
-	spriteAnimation->renderUsingCenter(
-		renderCenterX, renderCenterY, ticksTime - spriteAnimationStartTicksTime, 0, (int)spriteDirection);
-	(spriteAnimation->getSprite()->*SpriteSheet::setSpriteColor)(1.0f, 1.0f, 1.0f, 1.0f);
+		float renderCenterX = (float)((int)centerXs[i] + screenXOffset) + halfScreenWidth;
+		float renderCenterY = (float)((int)centerYs[i] + screenYOffset) + halfScreenHeight;
+		//skip particles that are entirely off screen, allowing a full sprite of margin in case it isn't anchored at its
+		//	center, plus the culling margin in case the camera moves before the frame is drawn
+		SpriteSheet* sprite = spriteAnimation->getSprite();
+		float marginX = (float)(sprite->getSpriteWidth() + MapState::renderCullingMargin);
+		float marginY = (float)(sprite->getSpriteHeight() + MapState::renderCullingMargin);
+		if (renderCenterX + marginX < 0.0f
+				|| renderCenterX - marginX > (float)Config::gameScreenWidth
+				|| renderCenterY + marginY < 0.0f
+				|| renderCenterY - marginY > (float)Config::gameScreenHeight)
+			continue;
+		(sprite->*SpriteSheet::setSpriteColor)((GLfloat)reds[i], (GLfloat)greens[i], (GLfloat)blues[i], 1.0f);
+		spriteAnimation->renderUsingCenter(
+			renderCenterX,
+			renderCenterY,
+			ticksTime - spriteAnimationStartTicksTimes[i],
+			0,
+			(int)spriteDirections[i]);
+		(sprite->*SpriteSheet::setSpriteColor)(1.0f, 1.0f, 1.0f, 1.0f);
+	}
 }
@@ -3,14 +3,14 @@
 #include "Util/PooledReferenceCounter.h"
 
 #define newDynamicCameraAnchor() produceWithoutArgs(DynamicCameraAnchor)
-#define newParticle(x, y, r, g, b, isAbovePlayer) produceWithArgs(Particle, x, y, r, g, b, isAbovePlayer)
-#define PIXELLATED_ZOOM
+#define newParticle(buffer) produceWithArgs(Particle, buffer)
 
 class DynamicValue;
 class EntityAnimation;
 class GameState;
 class Hint;
 class KickResetSwitchUndoState;
+class ParticleBuffer;
 class SpriteAnimation;
 namespace EntityAnimationTypes {
 	class Component;
@@ -24,10 +24,6 @@ enum class SpriteDirection: int {
 };
 class EntityState: public PooledReferenceCounter {
 private:
-	#ifdef PIXELLATED_ZOOM
-		static GLuint postZoomFrameBufferId;
-		static GLuint postZoomRenderBufferId;
-	#endif
 	static GLuint preZoomFrameBufferId;
 	static GLuint preZoomTextureId;
 
@@ -87,8 +83,6 @@ public:
 	float getRenderCenterScreenY(EntityState* camera, int ticksTime);
 	//return the screen y coordinate at the given time from the given world y coordinate and camera
 	static float getRenderCenterScreenYFromWorldY(float worldY, EntityState* camera, int ticksTime);
-	//get the duration of our entity animation, if we have one
-	int getAnimationTicksDuration();
 	//get a sprite direction based on movement velocity
 	static SpriteDirection getSpriteDirection(float pX, float pY);
 	//get a sprite direction in the opposite direction of the given sprite direction
@@ -99,13 +93,21 @@ public:
 	void setVelocity(DynamicValue* vx, DynamicValue* vy, int pLastUpdateTicksTime);
 	//set the zoom to be the given zoom
 	void setZoom(DynamicValue* pZoom, int pLastUpdateTicksTime);
-	//start the given entity animation
+	//start an entity animation with the given components, taking them out of the given vector
 	void beginEntityAnimation(vector<ReferenceCounterHolder<EntityAnimationTypes::Component>>* components, int ticksTime);
 	//setup rendering to render a zoomed image
 	//returns the zoom level being used, which should be passed back to renderEndZoom()
 	float renderBeginZoom(int ticksTime);
+private:
+	//direct rendering to the pre-zoom framebuffer
+	static void bindPreZoomFrameBuffer(float zoomValue);
+public:
 	//finish rendering the zoomed image at the given zoom value (returned by renderBeginZoom()), and render it to the screen
 	void renderEndZoom(float zoomValue);
+private:
+	//render the pre-zoom framebuffer to the screen at the given zoom value
+	static void drawZoomedFrameBuffer(float zoomValue);
+public:
 	//set the camera on the next game state, based on this being the previous game state's camera
 	virtual void setNextCamera(GameState* nextGameState, int ticksTime) = 0;
 };
@@ -142,37 +144,76 @@ public:
 	//render an overlay over the screen if applicable
 	void render(int ticksTime);
 };
+//a view of one particle in a ParticleBuffer, so that entity animations can update particles through the EntityState interface
+//particle animations can only use delays, sprite animations, sprite directions, and sounds
 class Particle: public EntityState {
 private:
-	SpriteAnimation* spriteAnimation;
-	int spriteAnimationStartTicksTime;
-	SpriteDirection spriteDirection;
-	float r;
-	float g;
-	float b;
-	bool isAbovePlayer;
+	ParticleBuffer* buffer;
+	int index;
 
 public:
 	Particle(objCounterParameters());
 	virtual ~Particle();
 
-	bool getIsAbovePlayer() { return isAbovePlayer; }
+	void setIndex(int pIndex) { index = pIndex; }
 	//don't do anything based on a camera change
 	virtual void setNextCamera(GameState* nextGameState, int ticksTime) {}
-	//initialize and return a Particle
-	static Particle* produce(objCounterParametersComma() float pX, float pY, float pR, float pG, float pB, bool pIsAbovePlayer);
-	//copy the state of the other Particle
-	void copyParticle(Particle* other);
+	//initialize and return a Particle that views particles in the given buffer
+	static Particle* produce(objCounterParametersComma() ParticleBuffer* pBuffer);
 	//release a reference to this Particle and return it to the pool if applicable
 	virtual void release();
-	//set the animation to the given animation at the given time
+	//set the animation of the viewed particle to the given animation at the given time
 	virtual void setSpriteAnimation(SpriteAnimation* pSpriteAnimation, int pSpriteAnimationStartTicksTime);
-	//set the sprite direction, and also set x and y directions to match
+	//set the sprite direction of the viewed particle
 	virtual void setDirection(SpriteDirection pSpriteDirection);
-	//update this Particle by reading from the previous state
-	//returns whether the animation is still running
-	bool updateWithPreviousParticle(Particle* prev, int ticksTime);
-	//render the sprite animation if applicable
-	void render(EntityState* camera, int ticksTime);
+};
+//particles stored as parallel arrays, so that they can be updated, compacted, and rendered in single passes over contiguous
+//	memory without an object per particle
+//Should only be allocated within an object, on the stack, or as a static object
+class ParticleBuffer {
+	friend class Particle;
+private:
+	vector<float> centerXs;
+	vector<float> centerYs;
+	vector<float> reds;
+	vector<float> greens;
+	vector<float> blues;
+	vector<bool> isAbovePlayers;
+	vector<SpriteAnimation*> spriteAnimations;
+	vector<int> spriteAnimationStartTicksTimes;
+	vector<SpriteDirection> spriteDirections;
+	vector<ReferenceCounterHolder<EntityAnimation>> entityAnimations;
+	//the Particle that entity animations update, produced once it's needed
+	ReferenceCounterHolder<Particle> particleView;
+
+public:
+	ParticleBuffer();
+	virtual ~ParticleBuffer();
+
+	bool isEmpty() { return centerXs.empty(); }
+	//remove all particles, keeping the memory to add new ones
+	void clear();
+private:
+	//resize all the particle arrays to the given count
+	void resize(int count);
+	//return the Particle that views the particle at the given index
+	Particle* getParticleView(int index);
+public:
+	//add a particle and start its entity animation with the given components
+	//returns the particle's entity animation
+	EntityAnimation* addParticle(
+		float centerX,
+		float centerY,
+		float r,
+		float g,
+		float b,
+		bool isAbovePlayer,
+		initializer_list<ReferenceCounterBorrow<EntityAnimationTypes::Component>> components,
+		int ticksTime);
+	//update every particle in the previous buffer into this one, dropping particles whose animations finished and keeping the
+	//	rest in order so that overlapping particles draw in the same order every frame
+	void updateWithPreviousParticleBuffer(ParticleBuffer* prev, int ticksTime);
+	//render the sprite animations of the particles that are either above or below the player
+	void render(EntityState* camera, bool renderAbovePlayer, int ticksTime);
 };
 #endif
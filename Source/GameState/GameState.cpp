@@ -33,6 +33,10 @@
 	newEntityAnimationSetDirection(direction), \
 	newEntityAnimationDelay(delay)
 
+int GameState::nextRenderCommandsRevision = 0;
+int GameState::lastRenderedCommandsRevision = -1;
+GLfloat GameState::lastRenderedCameraOffsetX = 0.0f;
+GLfloat GameState::lastRenderedCameraOffsetY = 0.0f;
 GameState::GameState(objCounterParameters())
 : onlyInDebug(ObjCounter(objCounterArguments()) COMMA)
 levelsUnlocked(0)
@@ -49,7 +53,16 @@ levelsUnlocked(0)
 , pauseState(nullptr)
 , pauseStartTicksTime(-1)
 , gameTimeOffsetTicksDuration(0)
-, shouldQuitGame(false) {
+, shouldQuitGame(false)
+, handledEvents(false)
+, renderCommands()
+, renderCommandsRevision(-1)
+, animating(false)
+, renderCommandsTicksTime(0)
+, renderCameraStartX(0.0f)
+, renderCameraStartY(0.0f)
+, renderCameraEndX(0.0f)
+, renderCameraEndY(0.0f) {
 }
 GameState::~GameState() {
 	//don't delete the camera, it's one of our other states
@@ -68,11 +81,12 @@ void GameState::updateWithPreviousGameState(GameState* prev, int ticksTime) {
 	titleAnimationStartTicksTime = prev->titleAnimationStartTicksTime;
 	lastSaveTicksTime = prev->lastSaveTicksTime;
 	savePerformed = prev->savePerformed;
+	handledEvents = false;
 
 	//don't update any state if we're paused
 	PauseState* lastPauseState = prev->pauseState.get();
 	if (lastPauseState != nullptr) {
-		PauseState* nextPauseState = lastPauseState->getNextPauseState();
+		PauseState* nextPauseState = lastPauseState->getNextPauseState(&handledEvents);
 		gameTimeOffsetTicksDuration = prev->gameTimeOffsetTicksDuration + ticksTime - prev->pauseStartTicksTime;
 		pauseStartTicksTime = ticksTime;
 		int gameTicksTime = ticksTime - gameTimeOffsetTicksDuration;
@@ -189,6 +203,7 @@ void GameState::updateWithPreviousGameState(GameState* prev, int ticksTime) {
 	//handle events after states have been updated
 	SDL_Event gameEvent;
 	while (SDL_PollEvent(&gameEvent) != 0) {
+		handledEvents = true;
 		switch (gameEvent.type) {
 			case SDL_QUIT:
 				shouldQuitGame = true;
@@ -358,7 +373,6 @@ void GameState::startRadioTowerAnimation(int ticksTime) {
 			newEntityAnimationSwitchToPlayerCamera(),
 			newEntityAnimationPlaySound(Audio::musics[lastActivatedSwitchColor], -1),
 	});
-	dynamicCameraAnchor.get()->beginEntityAnimation(&dynamicCameraAnchorAnimationComponents, ticksTime);
 
 	//delay the player for the duration of the animation
 	vector<ReferenceCounterHolder<EntityAnimationTypes::Component>> playerAnimationComponents ({
@@ -368,6 +382,9 @@ void GameState::startRadioTowerAnimation(int ticksTime) {
 		newEntityAnimationSetSpriteAnimation(nullptr),
 	});
 	EntityAnimation::delayToEndOf(playerAnimationComponents, dynamicCameraAnchorAnimationComponents);
+
+	//beginning the animations takes their components, so only begin them once we're done measuring them
+	dynamicCameraAnchor.get()->beginEntityAnimation(&dynamicCameraAnchorAnimationComponents, ticksTime);
 	playerState.get()->beginEntityAnimation(&playerAnimationComponents, ticksTime);
 	playerState.get()->clearUndoRedoStates();
 
@@ -398,17 +415,113 @@ void GameState::renderLoading(int ticksTime) {
 	Text::render(loadingText, leftX, baselineY, loadingFontScale);
 	Text::setRenderColor(1.0f, 1.0f, 1.0f, 1.0f);
 }
+bool GameState::recordRenderCommands(GameState* prev, int ticksTime) {
+	renderCommandsTicksTime = ticksTime;
+	int gameTicksTime = getGameTicksTime(ticksTime);
+	int endGameTicksTime = getGameTicksTime(ticksTime + Config::ticksPerSecond / Config::updatesPerSecond);
+	renderCameraStartX = camera->getRenderCenterWorldX(gameTicksTime);
+	renderCameraStartY = camera->getRenderCenterWorldY(gameTicksTime);
+	renderCameraEndX = camera->getRenderCenterWorldX(endGameTicksTime);
+	renderCameraEndY = camera->getRenderCenterWorldY(endGameTicksTime);
+	animating = checkAnimating(gameTicksTime, endGameTicksTime);
+
+	//the previous state drew everything where it is now, and nothing changed that isn't animated, so this state would draw
+	//	exactly the same thing
+	if (prev != nullptr
+		&& !prev->animating
+		&& !animating
+		&& !handledEvents
+		&& lastSaveTicksTime == prev->lastSaveTicksTime
+		&& mapState.get()->getHintState() == prev->mapState.get()->getHintState())
+	{
+		renderCommands = prev->renderCommands;
+		renderCommandsRevision = prev->renderCommandsRevision;
+		return false;
+	}
+
+	//the render thread doesn't hold onto lists, so if no other state shares ours, nothing else can be drawing it
+	if (renderCommands.use_count() == 1)
+		renderCommands->clear();
+	else
+		renderCommands = make_shared<RenderCommandList>();
+	renderCommandsRevision = nextRenderCommandsRevision++;
+	SpriteSheet::beginRecording(renderCommands.get());
+	render(ticksTime);
+	SpriteSheet::endRecording();
+	return true;
+}
+bool GameState::renderRecordedCommands(int ticksTime, bool forceRender) {
+	//the world was recorded where the camera was at the start of the update interval, so move it to where the camera is
+	//	now; it can't move farther than the culling margin without showing the edges of what was recorded
+	int updateTicksDuration = Config::ticksPerSecond / Config::updatesPerSecond;
+	float progress =
+		(float)MathUtils::min(MathUtils::max(ticksTime - renderCommandsTicksTime, 0), updateTicksDuration)
+			/ (float)updateTicksDuration;
+	int cameraDeltaX = (int)renderCameraStartX - (int)(renderCameraStartX + (renderCameraEndX - renderCameraStartX) * progress);
+	int cameraDeltaY = (int)renderCameraStartY - (int)(renderCameraStartY + (renderCameraEndY - renderCameraStartY) * progress);
+	GLfloat cameraOffsetX = (GLfloat)MathUtils::min(
+		MathUtils::max(cameraDeltaX, -MapState::renderCullingMargin), MapState::renderCullingMargin);
+	GLfloat cameraOffsetY = (GLfloat)MathUtils::min(
+		MathUtils::max(cameraDeltaY, -MapState::renderCullingMargin), MapState::renderCullingMargin);
+
+	//these commands are already on screen where they need to be
+	if (!forceRender
+			&& renderCommandsRevision == lastRenderedCommandsRevision
+			&& cameraOffsetX == lastRenderedCameraOffsetX
+			&& cameraOffsetY == lastRenderedCameraOffsetY)
+		return false;
+
+	SpriteSheet::renderCommands(renderCommands.get(), cameraOffsetX, cameraOffsetY);
+	lastRenderedCommandsRevision = renderCommandsRevision;
+	lastRenderedCameraOffsetX = cameraOffsetX;
+	lastRenderedCameraOffsetY = cameraOffsetY;
+	return true;
+}
+int GameState::getGameTicksTime(int ticksTime) {
+	return (pauseState.get() != nullptr ? pauseStartTicksTime : ticksTime) - gameTimeOffsetTicksDuration;
+}
+bool GameState::checkAnimating(int gameTicksTime, int endGameTicksTime) {
+	//game time doesn't pass while paused, so only events can change anything
+	if (pauseState.get() != nullptr)
+		return false;
+	PlayerState* player = playerState.get();
+	return renderCameraStartX != renderCameraEndX
+		|| renderCameraStartY != renderCameraEndY
+		|| player->getRenderCenterWorldX(gameTicksTime) != player->getRenderCenterWorldX(endGameTicksTime)
+		|| player->getRenderCenterWorldY(gameTicksTime) != player->getRenderCenterWorldY(endGameTicksTime)
+		|| player->isAnimating()
+		|| dynamicCameraAnchor.get()->hasAnimation()
+		|| mapState.get()->isAnimating(gameTicksTime)
+		|| textDisplayType != TextDisplayType::None
+		|| tutorialFreezePlayerStartTicksTime > 0
+		|| (savePerformed && gameTicksTime < lastSaveTicksTime + saveIconShowDuration)
+		|| Editor::isActive;
+}
 void GameState::render(int ticksTime) {
-	Editor::EditingMutexLocker editingMutexLocker;
-	int gameTicksTime = (pauseState.get() != nullptr ? pauseStartTicksTime : ticksTime) - gameTimeOffsetTicksDuration;
+	int gameTicksTime = getGameTicksTime(ticksTime);
 
 	float zoomValue = camera->renderBeginZoom(gameTicksTime);
-	Opengl::clearBackground();
+	SpriteSheet::renderFilledRectangle(
+		Config::backgroundColorRed,
+		Config::backgroundColorGreen,
+		Config::backgroundColorBlue,
+		1.0f,
+		0,
+		0,
+		(GLint)Config::windowScreenWidth,
+		(GLint)Config::windowScreenHeight);
 
 	//map and player rendering
+	SpriteSheet::beginCameraOffset();
 	char playerZ = (char)(floorf(playerState.get()->getDynamicZ(gameTicksTime) + 0.5f));
 	mapState.get()->renderBelowPlayer(camera, playerState.get()->getWorldGroundY(gameTicksTime), playerZ, gameTicksTime);
+	//the camera stays centered on the player when it follows the player, so don't move the player with the world
+	bool playerIsCamera = camera == playerState.get();
+	if (playerIsCamera)
+		SpriteSheet::endCameraOffset();
 	playerState.get()->render(camera, gameTicksTime);
+	if (playerIsCamera)
+		SpriteSheet::beginCameraOffset();
 	mapState.get()->renderAbovePlayer(camera, gameTicksTime);
 
 	//kick-action-related rendering
@@ -421,7 +534,12 @@ void GameState::render(int ticksTime) {
 	else if (playerState.get()->hasRailSwitchKickAction(KickActionType::Rail, &contextualGroupsRailSwitchId)
 			|| playerState.get()->hasRailSwitchKickAction(KickActionType::NoRail, &contextualGroupsRailSwitchId))
 		mapState.get()->renderGroupsForSwitchesFromRail(camera, contextualGroupsRailSwitchId, gameTicksTime);
+	if (playerIsCamera)
+		SpriteSheet::endCameraOffset();
+	//the kick action is drawn above the player, so it moves the same way the player does
 	playerState.get()->renderKickAction(camera, hasRailsToReset, gameTicksTime);
+	if (!playerIsCamera)
+		SpriteSheet::endCameraOffset();
 
 	camera->renderEndZoom(zoomValue);
 
@@ -455,6 +573,80 @@ void GameState::render(int ticksTime) {
 	if (Editor::isActive)
 		Editor::render(camera, gameTicksTime);
 }
+#ifdef DEBUG
+	void GameState::logUndoHistoryBytes() {
+		playerState.get()->logUndoHistoryBytes();
+	}
+	void GameState::benchmarkRender(bool saveImages) {
+		static constexpr int benchmarkFramesCount = 600;
+		static constexpr int benchmarkFrameTicksDuration = 16;
+		SDL_Surface* frameSurface = SDL_CreateRGBSurface(
+			0, Config::windowScreenWidth, Config::windowScreenHeight, 32, 0xFF0000, 0xFF00, 0xFF, 0xFF000000);
+		SDL_Renderer* frameRenderer = SDL_CreateSoftwareRenderer(frameSurface);
+		SDL_SetRenderDrawBlendMode(frameRenderer, SDL_BLENDMODE_BLEND);
+		SpriteSheet::renderWithRenderer(frameRenderer);
+		SpriteSheet::loadAllRenderTextures(frameRenderer);
+
+		//set up a state like a regular game in progress, with the tutorials showing
+		GameState* gameState = newGameState();
+		gameState->mapState.set(newMapState());
+		gameState->playerState.set(newPlayerState(gameState->mapState.get()));
+		gameState->dynamicCameraAnchor.set(newDynamicCameraAnchor());
+		gameState->playerState.get()->obtainBoot();
+		gameState->levelsUnlocked = 1;
+		gameState->camera = gameState->playerState.get();
+
+		//sweep the player across the map in rows a screen apart, alternating direction every row, at a steady speed
+		int mapPixelWidth = MapState::getMapWidth() * MapState::tileSize;
+		int rowsCount = MathUtils::max(1, MapState::getMapHeight() * MapState::tileSize / Config::gameScreenHeight);
+		float pathLength = (float)(mapPixelWidth * rowsCount);
+		vector<Uint64> frameDurations;
+		Uint64 performanceFrequency = SDL_GetPerformanceFrequency();
+		for (int frame = 0; frame < benchmarkFramesCount; frame++) {
+			float pathDistance = pathLength * (float)frame / (float)benchmarkFramesCount;
+			int row = (int)(pathDistance / (float)mapPixelWidth);
+			float rowDistance = pathDistance - (float)(row * mapPixelWidth);
+			float playerX = row % 2 == 0 ? rowDistance : (float)mapPixelWidth - rowDistance;
+			float playerY = ((float)row + 0.5f) * (float)Config::gameScreenHeight;
+			int ticksTime = frame * benchmarkFrameTicksDuration;
+			gameState->playerState.get()->setPosition(playerX, playerY, ticksTime);
+			gameState->playerState.get()->setInitialZ();
+
+			Uint64 frameStartTime = SDL_GetPerformanceCounter();
+			gameState->render(ticksTime);
+			SDL_RenderPresent(frameRenderer);
+			frameDurations.push_back(SDL_GetPerformanceCounter() - frameStartTime);
+
+			if (saveImages) {
+				char imageName[32];
+				snprintf(imageName, sizeof(imageName), "benchmark%04d.png", frame);
+				FileUtils::saveImage(frameSurface, imageName);
+			}
+		}
+
+		//log the results in microseconds
+		Uint64 totalDuration = 0;
+		for (Uint64 frameDuration : frameDurations)
+			totalDuration += frameDuration;
+		sort(frameDurations.begin(), frameDurations.end());
+		auto toMicroseconds = [performanceFrequency](Uint64 duration) {
+			return to_string(duration * 1000000 / performanceFrequency);
+		};
+		Logger::debugLogger.logString(
+			"Rendered " + to_string(benchmarkFramesCount) + " frames: average "
+				+ toMicroseconds(totalDuration / benchmarkFramesCount) + "us, median "
+				+ toMicroseconds(frameDurations[benchmarkFramesCount / 2]) + "us, 95th percentile "
+				+ toMicroseconds(frameDurations[benchmarkFramesCount * 95 / 100]) + "us, max "
+				+ toMicroseconds(frameDurations.back()) + "us");
+
+		//cleanup
+		delete gameState;
+		SpriteSheet::unloadAllRenderTextures();
+		SpriteSheet::renderWithOpenGL();
+		SDL_DestroyRenderer(frameRenderer);
+		SDL_FreeSurface(frameSurface);
+	}
+#endif
 void GameState::renderTextDisplay(int gameTicksTime) {
 	vector<string> textDisplayStrings;
 	vector<Text::Metrics> textDisplayMetrics;
@@ -931,12 +1123,12 @@ void GameState::beginIntroAnimation(int ticksTime) {
 			newEntityAnimationGenerateHint(&Hint::none),
 			newEntityAnimationPlaySound(Audio::stepOffRailSound, 0),
 		});
+	int animationEndTicksTime = EntityAnimation::getComponentTotalTicksDuration(playerAnimationComponents);
 	playerState.get()->beginEntityAnimation(&playerAnimationComponents, ticksTime);
 	//fix the initial z because the player teleported to the start of the intro animation
 	playerState.get()->setInitialZ();
 
 	int blackScreenFadeOutEndTime = introAnimationStartTicksTime + 1000;
-	int animationEndTicksTime = EntityAnimation::getComponentTotalTicksDuration(playerAnimationComponents);
 	int legLiftStartTime = animationEndTicksTime - SpriteRegistry::playerLegLiftAnimation->getTotalTicksDuration();
 	vector<ReferenceCounterHolder<EntityAnimationTypes::Component>> cameraAnimationComponents ({
 		newEntityAnimationSetPosition(MapState::introAnimationCameraCenterX, MapState::introAnimationCameraCenterY),
@@ -1161,9 +1353,9 @@ void GameState::beginOutroAnimation(int ticksTime) {
 				newConstantValue(0.0f), newConstantValue(0.0f), newConstantValue(0.0f), newConstantValue(0.0f)),
 			newEntityAnimationSwitchToPlayerCamera(),
 		});
+	EntityAnimation::delayToEndOf(playerAnimationComponents, dynamicCameraAnchorAnimationComponents);
 	dynamicCameraAnchor.get()->beginEntityAnimation(&dynamicCameraAnchorAnimationComponents, ticksTime);
 
-	EntityAnimation::delayToEndOf(playerAnimationComponents, dynamicCameraAnchorAnimationComponents);
 	playerAnimationComponents.insert(
 		playerAnimationComponents.end(),
 		{
@@ -1,4 +1,5 @@
 #include "GameState/MapState/MapState.h"
+#include "Sprites/SpriteSheet.h"
 
 #define newGameState() newWithoutArgs(GameState)
 
@@ -61,6 +62,13 @@ private:
 	static constexpr char* levelsUnlockedFilePrefix = "levelsUnlocked ";
 	static constexpr char* perpetualHintsFileValue = "perpetualHints";
 
+	//the revision to give the next commands recorded, only used on the update thread
+	static int nextRenderCommandsRevision;
+	//the revision and camera offset of the last frame drawn from recorded commands, only used on the render thread
+	static int lastRenderedCommandsRevision;
+	static GLfloat lastRenderedCameraOffsetX;
+	static GLfloat lastRenderedCameraOffsetY;
+
 	int levelsUnlocked;
 	bool perpetualHints;
 	TextDisplayType textDisplayType;
@@ -76,6 +84,23 @@ private:
 	int pauseStartTicksTime;
 	int gameTimeOffsetTicksDuration;
 	bool shouldQuitGame;
+	//whether any events were handled during the last update
+	bool handledEvents;
+	//recorded on the update thread after this state is updated, and drawn on the render thread
+	//the camera is evaluated where it is at the start and at the end of the update interval, so that the render thread
+	//	only has to interpolate between them to move the recorded world along with it
+	//a state that draws exactly what the state before it drew shares its commands and revision instead of recording them
+	//	again; the list may still be drawn after this state is updated, so it's replaced instead of changed while shared
+	shared_ptr<RenderCommandList> renderCommands;
+	int renderCommandsRevision;
+	//whether anything drawn for this state changes over time, so that the next state has to be recorded even if nothing
+	//	else changed
+	bool animating;
+	int renderCommandsTicksTime;
+	float renderCameraStartX;
+	float renderCameraStartY;
+	float renderCameraEndX;
+	float renderCameraEndY;
 
 public:
 	GameState(objCounterParameters());
@@ -83,6 +108,8 @@ public:
 
 	//return whether updates and renders should stop
 	bool getShouldQuitGame() { return shouldQuitGame; }
+	//return whether anything drawn for this state changes over time, as of when its render commands were recorded
+	bool isAnimating() { return animating; }
 	//update this GameState by reading from the previous state
 	void updateWithPreviousGameState(GameState* prev, int ticksTime);
 	//set our camera to our player
@@ -97,8 +124,34 @@ private:
 public:
 	//render a loading screen
 	static void renderLoading(int ticksTime);
-	//render this state, which was deemed to be the last state to need rendering
+	//record the commands to render this state at the given time, which should be the time it was updated, along with
+	//	where the camera will be over the update interval
+	//if neither this state nor the previous state is animating and nothing else changed, share the previous state's
+	//	commands instead
+	//returns whether new commands were recorded
+	bool recordRenderCommands(GameState* prev, int ticksTime);
+	//draw the recorded commands for this state, which was deemed to be the last state to need rendering, moving the world
+	//	to follow the camera to where it is at the given time
+	//skip drawing if it would draw the same frame as the last frame drawn, unless told to draw anyways
+	//returns whether anything was drawn
+	bool renderRecordedCommands(int ticksTime, bool forceRender);
+private:
+	//get the time to use for rendering the game at the given time, which stays the same while the game is paused
+	int getGameTicksTime(int ticksTime);
+	//returns whether anything drawn for this state changes between the given game times
+	//assumes the camera positions for rendering have already been set
+	bool checkAnimating(int gameTicksTime, int endGameTicksTime);
+	//render this state
 	void render(int ticksTime);
+public:
+	#ifdef DEBUG
+		//render frames with the software renderer into an in-memory surface, without a window or OpenGL, while moving the
+		//	player across the map, and log how long they took to render; optionally save every frame as an image
+		//the map must already be built and the sprites loaded
+		static void benchmarkRender(bool saveImages);
+		//log the approximate memory used by the player's undo and redo stacks
+		void logUndoHistoryBytes();
+	#endif
 private:
 	//render the title animation at the given time
 	void renderTextDisplay(int gameTicksTime);
@@ -39,9 +39,9 @@ Hint::~Hint() {
 }
 
 //////////////////////////////// HintState::PotentialLevelState ////////////////////////////////
-newInPlaceWithoutArgs(HintState::PotentialLevelState, HintState::PotentialLevelState::draftState);
+thread_local newInPlaceWithoutArgs(HintState::PotentialLevelState, HintState::PotentialLevelState::draftState);
 int HintState::PotentialLevelState::maxRailByteMaskCount = 0;
-int HintState::PotentialLevelState::currentRailByteMaskCount = 0;
+thread_local int HintState::PotentialLevelState::currentRailByteMaskCount = 0;
 HintState::PotentialLevelState::PotentialLevelState(objCounterParameters())
 : PooledReferenceCounter(objCounterArguments())
 , priorState(nullptr)
@@ -61,9 +61,9 @@ class HintState: public PooledReferenceCounter {
 public:
 	class PotentialLevelState: public PooledReferenceCounter {
 	public:
-		static PotentialLevelState draftState;
+		static thread_local PotentialLevelState draftState;
 		static int maxRailByteMaskCount;
-		static int currentRailByteMaskCount;
+		static thread_local int currentRailByteMaskCount;
 
 		PotentialLevelState* priorState;
 		unsigned int* railByteMasks;
@@ -124,6 +124,8 @@ public:
 	virtual ~HintState();
 
 	Hint::Type getHintType() { return hint->type; }
+	//returns whether this hint may still be fading out or blinking at the given time
+	bool isAnimating(int ticksTime) { return hint->type != Hint::Type::None && ticksTime < animationEndTicksTime; }
 	//initialize and return a HintState
 	static HintState* produce(objCounterParametersComma() Hint* pHint, int animationStartTicksTime);
 	//release a reference to this HintState and return it to the pool if applicable
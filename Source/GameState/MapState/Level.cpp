@@ -34,6 +34,24 @@ LevelTypes::RailByteMaskData::RailByteMaskData(Rail* pRail, short pRailId, ByteM
 }
 LevelTypes::RailByteMaskData::~RailByteMaskData() {}
 
+//////////////////////////////// LevelTypes::ConnectionGraph ////////////////////////////////
+LevelTypes::ConnectionGraph::ConnectionGraph()
+: planeConnectionsStart()
+, connectionToPlaneIndices()
+, connectionRailByteIndices()
+, connectionRailTileOffsetByteMasks()
+, connectionSteps()
+, planeCanVisitByteIndices()
+, planeCanVisitByteMasks()
+, planeMilestoneIsNewByteIndices()
+, planeMilestoneIsNewByteMasks()
+, connectionHints()
+, planes() {
+}
+LevelTypes::ConnectionGraph::~ConnectionGraph() {
+	//don't delete planes, they're owned by a Level
+}
+
 //////////////////////////////// LevelTypes::Plane::Tile ////////////////////////////////
 LevelTypes::Plane::Tile::Tile(int pX, int pY)
 : x(pX)
@@ -202,7 +220,13 @@ LevelTypes::Plane::DetailedLevel::DetailedLevel(Level* pLevel, vector<Plane*>& l
 , planes(levelPlanes.size())
 , rails((size_t)level->getRailByteMaskCount())
 , allConnectionSwitches()
-, victoryPlane(nullptr) {
+, victoryPlane(nullptr)
+, pathWalkSeenPlanes(levelPlanes.size(), false)
+, pathWalkNextConnectionIndices()
+, scratchPathPlanes()
+, scratchPathConnections()
+, scratchPlaneFlags(levelPlanes.size(), false)
+, scratchRailByteMasks((size_t)level->getRailByteMaskCount(), 0) {
 	//copy the basic structure
 	for (int i = 0; i < (int)levelPlanes.size(); i++) {
 		Plane* plane = levelPlanes[i];
@@ -264,38 +288,113 @@ void LevelTypes::Plane::DetailedLevel::findMilestones(RailByteMaskData::ByteMask
 
 	//recursively find milestones to destination planes, and track the planes for those milestones as destination planes
 	vector<DetailedPlane*> destinationPlanes ({ victoryPlane });
+	vector<DetailedConnection*> requiredConnections;
 	for (int i = 0; i < (int)destinationPlanes.size(); i++) {
 		//try to add a milestone switch for each required connection
-		for (DetailedConnection* requiredConnection : findRequiredConnectionsToPlane(destinationPlanes[i], true))
+		findRequiredConnectionsToPlane(destinationPlanes[i], true, requiredConnections);
+		for (DetailedConnection* requiredConnection : requiredConnections)
 			requiredConnection->tryAddMilestoneSwitch(destinationPlanes);
 	}
 }
-vector<LevelTypes::Plane::DetailedConnection*> LevelTypes::Plane::DetailedLevel::findRequiredConnectionsToPlane(
-	DetailedPlane* destination, bool excludeConnectionsFromSwitchesOnDestination)
+template <class ExcludeConnection, class CheckPath> bool LevelTypes::Plane::DetailedLevel::pathWalkToPlane(
+	DetailedPlane* destination,
+	bool excludeConnectionsFromSwitchesOnDestination,
+	ExcludeConnection excludeConnection,
+	vector<DetailedPlane*>& inOutPathPlanes,
+	vector<DetailedConnection*>& inOutPathConnections,
+	CheckPath checkPath)
+{
+	int initialPathPlanesCount = (int)inOutPathPlanes.size();
+	VectorUtils::fill(pathWalkSeenPlanes, false);
+	for (DetailedPlane* plane : inOutPathPlanes)
+		pathWalkSeenPlanes[plane->plane->indexInOwningLevel] = true;
+	//DFS to search for planes
+	//we track where to resume searching for every plane we add to the path, plus the plane we start from
+	//we never need to look at a connection again once we've passed it: it was either skipped, and will still be skipped, or
+	//	we followed it and marked its plane as seen
+	pathWalkNextConnectionIndices.clear();
+	pathWalkNextConnectionIndices.push_back(0);
+	while (true) {
+		vector<DetailedConnection>& lastPlaneConnections = inOutPathPlanes.back()->connections;
+		int& nextConnectionI = pathWalkNextConnectionIndices.back();
+		DetailedPlane* nextPlane = nullptr;
+		for (; nextConnectionI < (int)lastPlaneConnections.size(); nextConnectionI++) {
+			//skip a connection if:
+			//- it goes to a plane that we've already seen; we only care about the planes in the path, not the connections
+			//- we can't cross it without having already reached this destination plane
+			//- it's been excluded
+			DetailedConnection& detailedConnection = lastPlaneConnections[nextConnectionI];
+			DetailedPlane* toPlane = detailedConnection.toPlane;
+			if (pathWalkSeenPlanes[toPlane->plane->indexInOwningLevel]
+					|| (excludeConnectionsFromSwitchesOnDestination && detailedConnection.requiresSwitchesOnPlane(destination))
+					|| excludeConnection(&detailedConnection))
+				continue;
+			//we found a valid connection, track it
+			nextPlane = toPlane;
+			inOutPathConnections.push_back(&detailedConnection);
+			inOutPathPlanes.push_back(nextPlane);
+			pathWalkSeenPlanes[toPlane->plane->indexInOwningLevel] = true;
+			nextConnectionI++;
+			break;
+		}
+		//we found a connection and checkPath() accepted it
+		if (nextPlane != nullptr && checkPath()) {
+			//if it goes to this plane, we're done
+			if (nextPlane == destination)
+				return true;
+			pathWalkNextConnectionIndices.push_back(0);
+		//we found a connection but checkPath() rejected it; discard it and keep searching from the last plane
+		} else if (nextPlane != nullptr) {
+			inOutPathPlanes.pop_back();
+			inOutPathConnections.pop_back();
+		//we didn't find a valid connection from the last plane; go back to the previous plane
+		} else {
+			//if there are have no more planes we can visit after returning to the starting plane, we're done
+			if ((int)inOutPathPlanes.size() == initialPathPlanesCount)
+				return false;
+			inOutPathPlanes.pop_back();
+			inOutPathConnections.pop_back();
+			pathWalkNextConnectionIndices.pop_back();
+		}
+	}
+}
+bool LevelTypes::Plane::DetailedLevel::ExcludeRailByteMasks::operator()(DetailedConnection* detailedConnection) {
+	Connection* connection = detailedConnection->connection;
+	return connection->railBits.data.byteIndex != Level::absentRailByteIndex
+		&& ((*railByteMasks)[connection->railBits.data.byteIndex] & connection->railTileOffsetByteMask) != 0;
+}
+void LevelTypes::Plane::DetailedLevel::findRequiredConnectionsToPlane(
+	DetailedPlane* destination,
+	bool excludeConnectionsFromSwitchesOnDestination,
+	vector<DetailedConnection*>& outRequiredConnections)
 {
 	//find any path to this plane
 	//assuming this plane can be found in levelPlanes, we know there must be a path to get here from the starting plane, because
 	//	that's how we found this plane in the first place
 	vector<DetailedPlane*> pathPlanes ({ &planes[0] });
-	vector<DetailedConnection*> pathConnections;
+	vector<DetailedConnection*>& pathConnections = outRequiredConnections;
+	pathConnections.clear();
 	pathWalkToPlane(
 		destination,
 		excludeConnectionsFromSwitchesOnDestination,
-		excludeZeroConnections,
+		ExcludeZeroConnections(),
 		pathPlanes,
 		pathConnections,
-		alwaysAcceptPath);
+		AcceptAllPaths());
 
 	//prep some data about our path
 	vector<bool> connectionIsRequired (pathConnections.size(), true);
-	vector<bool> seenPlanes (planes.size(), false);
+	vector<bool>& seenPlanes = scratchPlaneFlags;
+	VectorUtils::fill(seenPlanes, false);
 	for (DetailedPlane* detailedPlane : pathPlanes)
 		seenPlanes[detailedPlane->plane->indexInOwningLevel] = true;
 
 	//go back and search again to find routes from each plane in the path toward later planes in the path, without going through
 	//	any of the connections in the path we already found
-	vector<DetailedPlane*> reroutePathPlanes;
-	vector<DetailedConnection*> reroutePathConnections;
+	vector<DetailedPlane*>& reroutePathPlanes = scratchPathPlanes;
+	vector<DetailedConnection*>& reroutePathConnections = scratchPathConnections;
+	reroutePathPlanes.clear();
+	reroutePathConnections.clear();
 	for (int i = 0; i < (int)pathConnections.size(); i++) {
 		reroutePathPlanes.push_back(pathPlanes[i]);
 		reroutePathConnections.push_back(pathConnections[i]);
@@ -313,7 +412,7 @@ vector<LevelTypes::Plane::DetailedConnection*> LevelTypes::Plane::DetailedLevel:
 		pathWalkToPlane(
 			destination,
 			excludeConnectionsFromSwitchesOnDestination,
-			excludeSingleConnection(reroutePathConnections.back()),
+			ExcludeSingleConnection { reroutePathConnections.back() },
 			reroutePathPlanes,
 			reroutePathConnections,
 			checkIfRerouteReturnsToOriginalPath);
@@ -323,8 +422,8 @@ vector<LevelTypes::Plane::DetailedConnection*> LevelTypes::Plane::DetailedLevel:
 	//	to this plane still goes through a rail with that switch
 	//find every single-use switch on not-required rails, and one switch at a time, exclude all connections for that switch, and
 	//	see if we can still find a path to this plane; if not, then re-mark that rail as required
-	vector<unsigned int> switchRailByteMasks ((size_t)level->getRailByteMaskCount(), 0);
-	function<bool(DetailedConnection* connection)> excludeSwitchConnections = excludeRailByteMasks(switchRailByteMasks);
+	vector<unsigned int>& switchRailByteMasks = scratchRailByteMasks;
+	ExcludeRailByteMasks excludeSwitchConnections { &switchRailByteMasks };
 	for (int i = 0; i < (int)pathConnections.size(); i++) {
 		//skip required connections
 		if (connectionIsRequired[i])
@@ -341,7 +440,8 @@ vector<LevelTypes::Plane::DetailedConnection*> LevelTypes::Plane::DetailedLevel:
 		//mark all of its rail connections as excluded, and see if we can find a path to this plane
 		VectorUtils::fill(switchRailByteMasks, 0U);
 		matchingConnectionSwitch->writeTileOffsetByteMasks(switchRailByteMasks);
-		reroutePathPlanes = { &planes[0] };
+		reroutePathPlanes.clear();
+		reroutePathPlanes.push_back(&planes[0]);
 		reroutePathConnections.clear();
 		//if there is not a path to this plane after excluding the switch's connections, then it is a milestone switch
 		//mark this rail as required, and we'll handle marking the switch as a milestone in the below loop
@@ -351,84 +451,17 @@ vector<LevelTypes::Plane::DetailedConnection*> LevelTypes::Plane::DetailedLevel:
 				excludeSwitchConnections,
 				reroutePathPlanes,
 				reroutePathConnections,
-				alwaysAcceptPath))
+				AcceptAllPaths()))
 			connectionIsRequired[i] = true;
 	}
 
-	//remove all non-required connections
-	for (int i = (int)pathConnections.size() - 1; i >= 0; i--) {
-		if (!connectionIsRequired[i])
-			pathConnections.erase(pathConnections.begin() + i);
-	}
-
-	return pathConnections;
-}
-bool LevelTypes::Plane::DetailedLevel::pathWalkToPlane(
-	DetailedPlane* destination,
-	bool excludeConnectionsFromSwitchesOnDestination,
-	function<bool(DetailedConnection* connection)> excludeConnection,
-	vector<DetailedPlane*>& inOutPathPlanes,
-	vector<DetailedConnection*>& inOutPathConnections,
-	function<bool()> checkPath)
-{
-	int initialPathPlanesCount = (int)inOutPathPlanes.size();
-	DetailedPlane* nextPlane = inOutPathPlanes.back();
-	vector<bool> seenPlanes (planes.size(), false);
-	for (DetailedPlane* plane : inOutPathPlanes)
-		seenPlanes[plane->plane->indexInOwningLevel] = true;
-	//DFS to search for planes
-	while (true) {
-		DetailedPlane* lastPlane = nextPlane;
-		for (DetailedConnection& detailedConnection : nextPlane->connections) {
-			//skip a connection if:
-			//- it goes to a plane that we've already seen; we only care about the planes in the path, not the connections
-			//- we can't cross it without having already reached this destination plane
-			//- it's been excluded
-			DetailedPlane* toPlane = detailedConnection.toPlane;
-			if (seenPlanes[toPlane->plane->indexInOwningLevel]
-					|| (excludeConnectionsFromSwitchesOnDestination && detailedConnection.requiresSwitchesOnPlane(destination))
-					|| excludeConnection(&detailedConnection))
-				continue;
-			//we found a valid connection, track it
-			nextPlane = toPlane;
-			inOutPathConnections.push_back(&detailedConnection);
-			inOutPathPlanes.push_back(nextPlane);
-			seenPlanes[toPlane->plane->indexInOwningLevel] = true;
-			break;
-		}
-		//we found a connection and checkPath() accepted it
-		if (nextPlane != lastPlane && checkPath()) {
-			//if it goes to this plane, we're done
-			if (nextPlane == destination)
-				return true;
-		//either we didn't find a valid connection from the last plane, or we did but checkPath() rejected it; go back to the
-		//	previous plane
-		} else {
-			//if there are have no more planes we can visit after returning to the starting plane, we're done
-			if ((int)inOutPathPlanes.size() == initialPathPlanesCount)
-				return false;
-			inOutPathPlanes.pop_back();
-			inOutPathConnections.pop_back();
-			nextPlane = inOutPathPlanes.back();
-		}
+	//remove all non-required connections, keeping the required ones in order
+	int requiredConnectionsCount = 0;
+	for (int i = 0; i < (int)pathConnections.size(); i++) {
+		if (connectionIsRequired[i])
+			pathConnections[requiredConnectionsCount++] = pathConnections[i];
 	}
-}
-bool LevelTypes::Plane::DetailedLevel::excludeRailConnections(DetailedConnection* connection) {
-	return connection->switchRail != nullptr;
-}
-function<bool(LevelTypes::Plane::DetailedConnection* connection)> LevelTypes::Plane::DetailedLevel::excludeSingleConnection(
-	DetailedConnection* excludedConnection)
-{
-	return [excludedConnection](DetailedConnection* detailedConnection) { return detailedConnection == excludedConnection; };
-}
-function<bool(LevelTypes::Plane::DetailedConnection* connection)> LevelTypes::Plane::DetailedLevel::excludeRailByteMasks(
-	vector<unsigned int>& railByteMasks)
-{
-	return [&railByteMasks](DetailedConnection* detailedConnection) {
-		Connection* connection = detailedConnection->connection;
-		return connection->railBits.data.byteIndex != Level::absentRailByteIndex
-			&& (railByteMasks[connection->railBits.data.byteIndex] & connection->railTileOffsetByteMask) != 0;
-	};
+	pathConnections.resize(requiredConnectionsCount);
 }
 void LevelTypes::Plane::DetailedLevel::findMiniPuzzles(short alwaysOnBitId) {
 	//now find mini puzzles
@@ -489,15 +522,19 @@ void LevelTypes::Plane::DetailedLevel::findMiniPuzzles(short alwaysOnBitId) {
 		}
 	}
 }
-void LevelTypes::Plane::DetailedLevel::findReachablePlanes(
-	function<bool(DetailedConnection* connection)> excludeConnection,
+template <class ExcludeConnection> void LevelTypes::Plane::DetailedLevel::findReachablePlanes(
+	ExcludeConnection excludeConnection,
 	vector<DetailedPlane*>* outReachablePlanes,
 	vector<DetailedPlane*>* outUnreachablePlanes)
 {
 	//find all planes that can or can't be reached with the given excluded connections
-	vector<DetailedPlane*> pathPlanes ({ &planes[0] });
-	vector<DetailedConnection*> pathConnections;
-	vector<bool> reachablePlanes (planes.size(), false);
+	vector<DetailedPlane*>& pathPlanes = scratchPathPlanes;
+	pathPlanes.clear();
+	pathPlanes.push_back(&planes[0]);
+	vector<DetailedConnection*>& pathConnections = scratchPathConnections;
+	pathConnections.clear();
+	vector<bool>& reachablePlanes = scratchPlaneFlags;
+	VectorUtils::fill(reachablePlanes, false);
 	reachablePlanes[0] = true;
 	auto trackPlaneAndKeepSearching = [&reachablePlanes, &pathPlanes, this]() {
 		reachablePlanes[pathPlanes.back()->plane->indexInOwningLevel] = true;
@@ -571,12 +608,15 @@ void LevelTypes::Plane::DetailedLevel::findDeadRails(RailByteMaskData::BitsLocat
 	vector<DetailedRail*> deadRails;
 	vector<vector<DetailedConnectionSwitch*>> allDeadRailAbandonedSwitches;
 	vector<DetailedConnectionSwitch*> deadRailSwitches;
+	vector<DetailedConnection*> requiredConnections;
+	vector<DetailedPlane*> deadPlanes;
 	for (DetailedConnectionSwitch* completedSwitch : allConnectionSwitches) {
 		if (!completedSwitch->connectionSwitch->isSingleUse)
 			continue;
 		//find all rails that are required for this switch and do not restrict any planes with non-single-use switches (or the
 		//	victory plane)
-		for (DetailedConnection* requiredConnection : findRequiredConnectionsToPlane(completedSwitch->owningPlane, false)) {
+		findRequiredConnectionsToPlane(completedSwitch->owningPlane, false, requiredConnections);
+		for (DetailedConnection* requiredConnection : requiredConnections) {
 			//skip plane-plane connections and always-raised rails
 			DetailedRail* requiredRail = requiredConnection->switchRail;
 			if (requiredRail == nullptr)
@@ -586,8 +626,8 @@ void LevelTypes::Plane::DetailedLevel::findDeadRails(RailByteMaskData::BitsLocat
 			unsigned int deadRailIndex = VectorUtils::indexOf(deadRails, requiredRail);
 			if (deadRailIndex == deadRails.size()) {
 				//verify that this rail only restricts single-use switches, and does not restrict the victory plane
-				vector<DetailedPlane*> deadPlanes;
-				findReachablePlanes(excludeSingleConnection(requiredConnection), nullptr, &deadPlanes);
+				deadPlanes.clear();
+				findReachablePlanes(ExcludeSingleConnection { requiredConnection }, nullptr, &deadPlanes);
 				if (VectorUtils::anyMatch(deadPlanes, isAlwaysLivePlane))
 					continue;
 
@@ -607,6 +647,8 @@ void LevelTypes::Plane::DetailedLevel::findDeadRails(RailByteMaskData::BitsLocat
 
 	//now go through every switch that affects a dead rail, and mark it as a dead rail switch if all its live rails are only
 	//	affected by it
+	vector<bool> isDeadRail;
+	vector<DetailedConnectionSwitch*> deadRailSwitchCompletedSwitches;
 	for (DetailedConnectionSwitch* deadRailSwitch : deadRailSwitches) {
 		//skip switches that already have can-kick bits (single-use switches) but allow mini puzzle switches, which subsede
 		//	being dead rail switches
@@ -617,8 +659,8 @@ void LevelTypes::Plane::DetailedLevel::findDeadRails(RailByteMaskData::BitsLocat
 		//now go through every rail on this switch and mark it as a live rail or dead rail, and verify that all live rails
 		//	are only affected by it
 		//at the same time, collect all the switches we're abandoning
-		vector<bool> isDeadRail;
-		vector<DetailedConnectionSwitch*> deadRailSwitchCompletedSwitches;
+		isDeadRail.clear();
+		deadRailSwitchCompletedSwitches.clear();
 		auto isInvalidLiveRail =
 			[&deadRails, &allDeadRailAbandonedSwitches, &isDeadRail, &deadRailSwitchCompletedSwitches](DetailedRail* switchRail)
 		{
@@ -671,7 +713,7 @@ void LevelTypes::Plane::DetailedLevel::findDeadRails(RailByteMaskData::BitsLocat
 void LevelTypes::Plane::DetailedLevel::findIsolatedAreas(short alwaysOnBitId) {
 	//first step, collect all planes reachable without rails
 	vector<DetailedPlane*> basePlanes;
-	findReachablePlanes(excludeRailConnections, &basePlanes, nullptr);
+	findReachablePlanes(ExcludeRailConnections(), &basePlanes, nullptr);
 	vector<bool> seenPlanes (planes.size());
 	for (DetailedPlane* basePlane : basePlanes)
 		seenPlanes[basePlane->plane->indexInOwningLevel] = true;
@@ -723,7 +765,7 @@ void LevelTypes::Plane::DetailedLevel::tryAddIsolatedAreaThroughConnection(
 	basePlanes.push_back(baseRailConnection->toPlane);
 	trackPlaneAndKeepSearching();
 	pathWalkToPlane(
-		&planes[0], false, excludeZeroConnections, basePlanes, ignorePathConnections, trackPlaneAndKeepSearching);
+		&planes[0], false, ExcludeZeroConnections(), basePlanes, ignorePathConnections, trackPlaneAndKeepSearching);
 	basePlanes.pop_back();
 
 	//we can't abandon the victory plane
@@ -957,6 +999,38 @@ void LevelTypes::Plane::removeEmptyPlaneConnections(short alwaysOffBitId) {
 	};
 	VectorUtils::filterErase(connections, isEmptyPlaneConnection);
 }
+void LevelTypes::Plane::compileConnectionGraph(vector<Plane*>& levelPlanes, ConnectionGraph* outConnectionGraph) {
+	int connectionsCount = 0;
+	for (Plane* plane : levelPlanes)
+		connectionsCount += (int)plane->connections.size();
+	outConnectionGraph->planeConnectionsStart.reserve(levelPlanes.size() + 1);
+	outConnectionGraph->connectionToPlaneIndices.reserve(connectionsCount);
+	outConnectionGraph->connectionRailByteIndices.reserve(connectionsCount);
+	outConnectionGraph->connectionRailTileOffsetByteMasks.reserve(connectionsCount);
+	outConnectionGraph->connectionSteps.reserve(connectionsCount);
+	outConnectionGraph->connectionHints.reserve(connectionsCount);
+	for (Plane* plane : levelPlanes) {
+		outConnectionGraph->planeConnectionsStart.push_back((int)outConnectionGraph->connectionToPlaneIndices.size());
+		for (Connection& connection : plane->connections) {
+			bool isRailConnection = connection.railBits.data.byteIndex != Level::absentRailByteIndex;
+			outConnectionGraph->connectionToPlaneIndices.push_back(connection.toPlane->indexInOwningLevel);
+			outConnectionGraph->connectionRailByteIndices.push_back(isRailConnection ? connection.railBits.data.byteIndex : 0);
+			outConnectionGraph->connectionRailTileOffsetByteMasks.push_back(
+				isRailConnection ? connection.railTileOffsetByteMask : 0);
+			outConnectionGraph->connectionSteps.push_back(connection.steps);
+			outConnectionGraph->connectionHints.push_back(&connection.hint);
+		}
+		bool hasMilestoneIsNewBit = plane->milestoneIsNewBit.location.data.byteIndex != Level::absentRailByteIndex;
+		outConnectionGraph->planeCanVisitByteIndices.push_back(plane->canVisitBit.location.data.byteIndex);
+		outConnectionGraph->planeCanVisitByteMasks.push_back(plane->canVisitBit.byteMask);
+		outConnectionGraph->planeMilestoneIsNewByteIndices.push_back(
+			hasMilestoneIsNewBit ? plane->milestoneIsNewBit.location.data.byteIndex : 0);
+		outConnectionGraph->planeMilestoneIsNewByteMasks.push_back(
+			hasMilestoneIsNewBit ? plane->milestoneIsNewBit.byteMask : 0);
+		outConnectionGraph->planes.push_back(plane);
+	}
+	outConnectionGraph->planeConnectionsStart.push_back(connectionsCount);
+}
 void LevelTypes::Plane::markStatusBitsInDraftState(vector<Plane*>& levelPlanes) {
 	//mark switches as can-kick if any of their connections are lowered
 	//this will also mark planes as can-visit and milestone-is-new where those bits are set to the same value
@@ -1026,6 +1100,17 @@ bool LevelTypes::Plane::markStatusBitsInDraftStateOnMilestone(vector<Plane*>& le
 void LevelTypes::Plane::pursueSolutionToPlanes(HintState::PotentialLevelState* currentState, int basePotentialLevelStateSteps) {
 	unsigned int bucket = currentState->railByteMasksHash % Level::PotentialLevelStatesByBucket::bucketSize;
 	unsigned int* railByteMasks = currentState->railByteMasks;
+	//read everything from the flattened connection graph so that we go through sequential memory
+	ConnectionGraph* connectionGraph = owningLevel->getConnectionGraph();
+	int* planeConnectionsStart = connectionGraph->planeConnectionsStart.data();
+	int* connectionToPlaneIndices = connectionGraph->connectionToPlaneIndices.data();
+	char* connectionRailByteIndices = connectionGraph->connectionRailByteIndices.data();
+	unsigned int* connectionRailTileOffsetByteMasks = connectionGraph->connectionRailTileOffsetByteMasks.data();
+	int* allConnectionSteps = connectionGraph->connectionSteps.data();
+	char* planeCanVisitByteIndices = connectionGraph->planeCanVisitByteIndices.data();
+	unsigned int* planeCanVisitByteMasks = connectionGraph->planeCanVisitByteMasks.data();
+	char* planeMilestoneIsNewByteIndices = connectionGraph->planeMilestoneIsNewByteIndices.data();
+	unsigned int* planeMilestoneIsNewByteMasks = connectionGraph->planeMilestoneIsNewByteMasks.data();
 	Level::CheckedPlaneData* checkedPlaneData = &Level::checkedPlaneDatas[indexInOwningLevel];
 	checkedPlaneData->steps = 0;
 	checkedPlaneData->checkPlanesIndex = 0;
@@ -1037,17 +1122,18 @@ void LevelTypes::Plane::pursueSolutionToPlanes(HintState::PotentialLevelState* c
 	for (int steps = 0; steps <= maxStepsSeen; steps++) {
 		Plane** checkPlanes = Level::allCheckPlanes[steps];
 		for (int i = Level::checkPlaneCounts[steps] - 1; i >= 0; i--) {
-			Plane* checkPlane = checkPlanes[i];
-			for (Connection& connection : checkPlane->connections) {
+			int checkPlaneIndex = checkPlanes[i]->indexInOwningLevel;
+			int connectionsEnd = planeConnectionsStart[checkPlaneIndex + 1];
+			for (int connectionI = planeConnectionsStart[checkPlaneIndex]; connectionI < connectionsEnd; connectionI++) {
 				//skip it if we can't pass
-				if (connection.railBits.data.byteIndex != Level::absentRailByteIndex
-						&& (railByteMasks[connection.railBits.data.byteIndex] & connection.railTileOffsetByteMask) != 0)
+				//plane-plane connections have an empty byte mask, so they always pass
+				if ((railByteMasks[connectionRailByteIndices[connectionI]] & connectionRailTileOffsetByteMasks[connectionI])
+						!= 0)
 					continue;
 
-				Plane* connectionToPlane = connection.toPlane;
-				int toPlaneIndex = connectionToPlane->indexInOwningLevel;
+				int toPlaneIndex = connectionToPlaneIndices[connectionI];
 				int checkedPlaneSteps = (checkedPlaneData = Level::checkedPlaneDatas + toPlaneIndex)->steps;
-				int connectionSteps = steps + connection.steps;
+				int connectionSteps = steps + allConnectionSteps[connectionI];
 				//skip it if it takes equal or more steps than the path we already found
 				//unvisited planes have a large number for steps so this will only be true for visited planes
 				if (connectionSteps >= checkedPlaneSteps)
@@ -1066,19 +1152,18 @@ void LevelTypes::Plane::pursueSolutionToPlanes(HintState::PotentialLevelState* c
 				}
 
 				//track its data
+				Plane* connectionToPlane = connectionGraph->planes[toPlaneIndex];
 				checkedPlaneData->steps = connectionSteps;
 				checkedPlaneData->hint =
 					//use the hint from the connection for connections from the first plane, otherwise copy the hint that got to
 					//	this plane
-					steps == 0 ? &connection.hint : Level::checkedPlaneDatas[checkPlane->indexInOwningLevel].hint;
+					steps == 0 ? connectionGraph->connectionHints[connectionI] : Level::checkedPlaneDatas[checkPlaneIndex].hint;
 				int checkPlanesIndex = (checkedPlaneData->checkPlanesIndex = Level::checkPlaneCounts[connectionSteps]++);
 				Level::allCheckPlanes[connectionSteps][checkPlanesIndex] = connectionToPlane;
 				if (connectionSteps > maxStepsSeen)
 					maxStepsSeen = connectionSteps;
 				//we're done if the state can't be visited
-				if ((railByteMasks[connectionToPlane->canVisitBit.location.data.byteIndex]
-							& connectionToPlane->canVisitBit.byteMask)
-						== 0)
+				if ((railByteMasks[planeCanVisitByteIndices[toPlaneIndex]] & planeCanVisitByteMasks[toPlaneIndex]) == 0)
 					continue;
 
 				//if it can be visited, add a state to it
@@ -1095,9 +1180,8 @@ void LevelTypes::Plane::pursueSolutionToPlanes(HintState::PotentialLevelState* c
 
 				//if it goes to a milestone destination plane that we haven't visited yet from this state, try to frontload it
 				//	instead of tracking it at its steps
-				if (connectionToPlane->milestoneIsNewBit.location.data.byteIndex != Level::absentRailByteIndex
-						&& (railByteMasks[connectionToPlane->milestoneIsNewBit.location.data.byteIndex]
-								& connectionToPlane->milestoneIsNewBit.byteMask)
+				//planes without a milestone-is-new bit have an empty byte mask, so they never pass
+				if ((railByteMasks[planeMilestoneIsNewByteIndices[toPlaneIndex]] & planeMilestoneIsNewByteMasks[toPlaneIndex])
 							!= 0
 						&& Level::frontloadMilestoneDestinationState(nextPotentialLevelState))
 					continue;
@@ -1431,37 +1515,50 @@ Level::IsolatedArea::IsolatedArea(
 }
 Level::IsolatedArea::~IsolatedArea() {}
 
+#ifdef TEST_SOLUTIONS
+	//////////////////////////////// Level::SolutionTest ////////////////////////////////
+	Level::SolutionTest::SolutionTest(Level* pLevel, string& pName, int pStartLineN)
+	: level(pLevel)
+	, name(pName)
+	, startLineN(pStartLineN)
+	, verified(false)
+	, ticksDuration(0) {
+	}
+	Level::SolutionTest::~SolutionTest() {}
+#endif
+
 //////////////////////////////// Level ////////////////////////////////
 RailByteMaskData::ByteMask Level::absentBits (RailByteMaskData::BitsLocation(absentRailByteIndex, 0), 0);
-bool Level::hintSearchIsRunning = false;
-vector<Level::PotentialLevelStatesByBucket> Level::potentialLevelStatesByBucketByPlane;
-vector<HintState::PotentialLevelState*> Level::replacedPotentialLevelStates;
-short Level::cachedAlwaysOnBitId = Level::absentBits.location.id;
-Plane*** Level::allCheckPlanes = nullptr;
-int* Level::checkPlaneCounts = nullptr;
-Level::CheckedPlaneData* Level::checkedPlaneDatas = nullptr;
-int* Level::checkedPlaneIndices = nullptr;
-int Level::currentPotentialLevelStateSteps = 0;
-vector<int> Level::currentPotentialLevelStateStepsForMilestones;
-int Level::maxPotentialLevelStateSteps = -1;
-vector<int> Level::maxPotentialLevelStateStepsForMilestones;
-int Level::currentMilestones = 0;
-deque<HintState::PotentialLevelState*>* Level::currentNextPotentialLevelStates = nullptr;
-vector<deque<HintState::PotentialLevelState*>*>* Level::currentNextPotentialLevelStatesBySteps = nullptr;
-vector<vector<deque<HintState::PotentialLevelState*>*>> Level::nextPotentialLevelStatesByStepsByMilestone;
-int Level::hintSearchCheckStateI = 0;
-Plane* Level::cachedHintSearchVictoryPlane = nullptr;
-bool Level::enableHintSearchTimeout = true;
+atomic<bool> Level::hintSearchCanceled (false);
+int Level::maxHintSearchPlaneCount = 0;
+thread_local vector<Level::PotentialLevelStatesByBucket> Level::potentialLevelStatesByBucketByPlane;
+thread_local vector<HintState::PotentialLevelState*> Level::replacedPotentialLevelStates;
+thread_local short Level::cachedAlwaysOnBitId = Level::absentBits.location.id;
+thread_local Plane*** Level::allCheckPlanes = nullptr;
+thread_local int* Level::checkPlaneCounts = nullptr;
+thread_local Level::CheckedPlaneData* Level::checkedPlaneDatas = nullptr;
+thread_local int* Level::checkedPlaneIndices = nullptr;
+thread_local int Level::currentPotentialLevelStateSteps = 0;
+thread_local vector<int> Level::currentPotentialLevelStateStepsForMilestones;
+thread_local int Level::maxPotentialLevelStateSteps = -1;
+thread_local vector<int> Level::maxPotentialLevelStateStepsForMilestones;
+thread_local int Level::currentMilestones = 0;
+thread_local deque<HintState::PotentialLevelState*>* Level::currentNextPotentialLevelStates = nullptr;
+thread_local vector<deque<HintState::PotentialLevelState*>*>* Level::currentNextPotentialLevelStatesBySteps = nullptr;
+thread_local vector<vector<deque<HintState::PotentialLevelState*>*>> Level::nextPotentialLevelStatesByStepsByMilestone;
+thread_local int Level::hintSearchCheckStateI = 0;
+thread_local Plane* Level::cachedHintSearchVictoryPlane = nullptr;
+thread_local bool Level::enableHintSearchTimeout = true;
 #ifdef LOG_SEARCH_STEPS_STATS
-	int* Level::statesAtStepsByPlane = nullptr;
-	int* Level::statesAtStepsFromPlane = nullptr;
+	thread_local int* Level::statesAtStepsByPlane = nullptr;
+	thread_local int* Level::statesAtStepsFromPlane = nullptr;
 #endif
 #ifdef TRACK_HINT_SEARCH_STATS
-	int Level::hintSearchActionsChecked = 0;
-	int Level::hintSearchComparisonsPerformed = 0;
+	thread_local int Level::hintSearchActionsChecked = 0;
+	thread_local int Level::hintSearchComparisonsPerformed = 0;
 #endif
-int Level::foundHintSearchTotalHintSteps = 0;
-int Level::foundHintSearchTotalSteps = 0;
+thread_local int Level::foundHintSearchTotalHintSteps = 0;
+thread_local int Level::foundHintSearchTotalSteps = 0;
 Level::Level(objCounterParametersComma() int pLevelN, int pStartTile)
 : onlyInDebug(ObjCounter(objCounterArguments()) COMMA)
 levelN(pLevelN)
@@ -1477,7 +1574,9 @@ levelN(pLevelN)
 , minimumRailColor(0)
 , radioTowerHint(Hint::Type::None)
 , undoResetHint(Hint::Type::UndoReset)
-, searchCanceledEarlyHint(Hint::Type::SearchCanceledEarly) {
+, searchCanceledEarlyHint(Hint::Type::SearchCanceledEarly)
+, startStateHint(nullptr)
+, connectionGraph() {
 }
 Level::~Level() {
 	for (Plane* plane : planes)
@@ -1533,32 +1632,34 @@ void Level::finalizeBuilding() {
 		}
 	#endif
 	Plane::finalizeBuilding(this, planes, alwaysOffBit, alwaysOnBit);
+	Plane::compileConnectionGraph(planes, &connectionGraph);
 }
 void Level::setupHintSearchHelpers(vector<Level*>& allLevels) {
 	for (Level* level : allLevels) {
-		//add one PotentialLevelStatesByBucket per plane, which includes the victory plane
-		while (potentialLevelStatesByBucketByPlane.size() < level->planes.size())
-			potentialLevelStatesByBucketByPlane.push_back(PotentialLevelStatesByBucket());
+		//track one PotentialLevelStatesByBucket per plane, which includes the victory plane
+		maxHintSearchPlaneCount = MathUtils::max(maxHintSearchPlaneCount, (int)level->planes.size());
 		HintState::PotentialLevelState::maxRailByteMaskCount =
 			MathUtils::max(HintState::PotentialLevelState::maxRailByteMaskCount, level->getRailByteMaskCount());
 	}
+}
+void Level::setupThreadHintSearchHelpers() {
+	potentialLevelStatesByBucketByPlane = vector<PotentialLevelStatesByBucket>(maxHintSearchPlaneCount);
 	nextPotentialLevelStatesByStepsByMilestone.push_back(vector<deque<HintState::PotentialLevelState*>*>());
-	//just once, fix the draft state byte list
+	//fix the draft state byte list now that we know how big it needs to be
 	delete[] HintState::PotentialLevelState::draftState.railByteMasks;
 	HintState::PotentialLevelState::draftState.railByteMasks =
 		new unsigned int[HintState::PotentialLevelState::maxRailByteMaskCount];
 	//setup plane-search helpers
-	int maxPlaneCount = (int)potentialLevelStatesByBucketByPlane.size();
 	//for checkPlanes, it's impossible for a path to take more than planes-count steps, so use that as the size of the array
-	allCheckPlanes = new Plane**[maxPlaneCount];
-	for (int i = 0; i < maxPlaneCount; i++)
-		allCheckPlanes[i] = new Plane*[maxPlaneCount];
-	checkPlaneCounts = new int[maxPlaneCount] {};
-	checkedPlaneDatas = new CheckedPlaneData[maxPlaneCount];
-	checkedPlaneIndices = new int[maxPlaneCount];
+	allCheckPlanes = new Plane**[maxHintSearchPlaneCount];
+	for (int i = 0; i < maxHintSearchPlaneCount; i++)
+		allCheckPlanes[i] = new Plane*[maxHintSearchPlaneCount];
+	checkPlaneCounts = new int[maxHintSearchPlaneCount] {};
+	checkedPlaneDatas = new CheckedPlaneData[maxHintSearchPlaneCount];
+	checkedPlaneIndices = new int[maxHintSearchPlaneCount];
 	#ifdef LOG_SEARCH_STEPS_STATS
-		statesAtStepsByPlane = new int[maxPlaneCount] {};
-		statesAtStepsFromPlane = new int[maxPlaneCount] {};
+		statesAtStepsByPlane = new int[maxHintSearchPlaneCount] {};
+		statesAtStepsFromPlane = new int[maxHintSearchPlaneCount] {};
 	#endif
 }
 void Level::deleteHelpers() {
@@ -1583,17 +1684,34 @@ void Level::deleteHelpers() {
 		delete[] statesAtStepsFromPlane;
 	#endif
 }
-void Level::preAllocatePotentialLevelStates() {
-	auto getRailState = [](short railId, Rail* rail, char* outMovementDirection, char* outTileOffset) {
-		*outMovementDirection = rail->getInitialMovementDirection();
-		*outTileOffset = rail->getInitialTileOffset();
-	};
+void Level::getInitialRailState(short railId, Rail* rail, char* outMovementDirection, char* outTileOffset) {
+	*outMovementDirection = rail->getInitialMovementDirection();
+	*outTileOffset = rail->getInitialTileOffset();
+}
+bool Level::prefetchStartStateHint() {
 	enableHintSearchTimeout = false;
-	generateHint(planes[0], getRailState, minimumRailColor);
+	Hint* result = generateHint(planes[0], getInitialRailState, minimumRailColor);
 	enableHintSearchTimeout = true;
+	//don't cache the hint if the search was canceled, we'll search again next time
+	if (result == &Hint::genericSearchCanceledEarly)
+		return false;
+	startStateHint = result;
 	#ifdef TEST_SOLUTIONS
-		testSolutions(getRailState);
+		testSolutions(getInitialRailState);
 	#endif
+	return true;
+}
+Hint* Level::getStartStateHint(Plane* currentPlane, GetRailState getRailState, char lastActivatedSwitchColor) {
+	if (startStateHint == nullptr || currentPlane != planes[0] || lastActivatedSwitchColor < minimumRailColor)
+		return nullptr;
+	for (RailByteMaskData& railByteMaskData : allRailByteMaskData) {
+		char movementDirection, tileOffset;
+		getRailState(railByteMaskData.railId, railByteMaskData.rail, &movementDirection, &tileOffset);
+		if (movementDirection != railByteMaskData.rail->getInitialMovementDirection()
+				|| tileOffset != railByteMaskData.rail->getInitialTileOffset())
+			return nullptr;
+	}
+	return startStateHint;
 }
 #ifdef DEBUG
 	void Level::validateResetSwitch() {
@@ -1620,7 +1738,6 @@ void Level::preAllocatePotentialLevelStates() {
 	}
 #endif
 Hint* Level::generateHint(Plane* currentPlane, GetRailState getRailState, char lastActivatedSwitchColor) {
-	hintSearchIsRunning = true;
 	if (lastActivatedSwitchColor < minimumRailColor)
 		return &radioTowerHint;
 	else if (victoryPlane == nullptr)
@@ -1660,8 +1777,6 @@ Hint* Level::generateHint(Plane* currentPlane, GetRailState getRailState, char l
 	if (result->isAdvancement())
 		hintSearchPerformanceMessage << "  steps " << foundHintSearchTotalSteps << "(" << foundHintSearchTotalHintSteps << ")";
 	Logger::debugLogger.logString(hintSearchPerformanceMessage.str());
-
-	hintSearchIsRunning = false;
 	return result;
 }
 void Level::resetPlaneSearchHelpers() {
@@ -1793,7 +1908,7 @@ Hint* Level::performHintSearch(HintState::PotentialLevelState* baseLevelState, P
 		}
 
 		//bail if the search was canceled or took too long
-		if (!hintSearchIsRunning) {
+		if (hintSearchCanceled) {
 			Logger::debugLogger.logString("hint search canceled");
 			return &Hint::genericSearchCanceledEarly;
 		}
@@ -1866,9 +1981,8 @@ int Level::clearPotentialLevelStateHolders() {
 	void Level::testSolutions(GetRailState getRailState) {
 		if (victoryPlane == nullptr)
 			return;
-		string filename = "test_solutions/" + to_string(levelN) + ".txt";
 		ifstream file;
-		FileUtils::openFileForRead(&file, filename.c_str(), FileUtils::FileReadLocation::Installation);
+		openSolutionsFile(file);
 		string line;
 		for (int lineN = 1; getline(file, line); lineN++) {
 			if (line.empty() || StringUtils::startsWith(line, "#"))
@@ -1882,7 +1996,7 @@ int Level::clearPotentialLevelStateHolders() {
 		}
 		file.close();
 	}
-	void Level::testSolution(GetRailState getRailState, ifstream& file, int& lineN) {
+	bool Level::testSolution(GetRailState getRailState, ifstream& file, int& lineN) {
 		//start by finding the initial set of planes
 		resetPlaneSearchHelpers();
 		HintState::PotentialLevelState* baseLevelState = loadBasePotentialLevelState(planes[0], getRailState);
@@ -1890,6 +2004,7 @@ int Level::clearPotentialLevelStateHolders() {
 		baseLevelState->plane->pursueSolutionToPlanes(baseLevelState, 0);
 
 		//collect all the initially reachable states
+		bool verified = true;
 		vector<HintState::PotentialLevelState*> statesAtSolutionStep;
 		auto collectAllStates = [&statesAtSolutionStep]() {
 			statesAtSolutionStep.clear();
@@ -1933,6 +2048,7 @@ int Level::clearPotentialLevelStateHolders() {
 				Logger::debugLogger.logString(
 					"ERROR: level " + to_string(levelN) + " solution line " + to_string(lineN)
 						+ ": missing color prefix: \"" + line + "\"");
+				verified = false;
 				break;
 			}
 			const char* switchGroupName = line.c_str() + strlen(switchColorPrefixes[color]);
@@ -1946,6 +2062,7 @@ int Level::clearPotentialLevelStateHolders() {
 				Logger::debugLogger.logString(
 					"ERROR: level " + to_string(levelN) + " solution line " + to_string(lineN)
 						+ ": unable to reach switch, or state has already been seen: \"" + line + "\"");
+				verified = false;
 				break;
 			}
 			if (switchIsMilestone != expectMilestoneSwitch) {
@@ -1953,6 +2070,7 @@ int Level::clearPotentialLevelStateHolders() {
 					"ERROR: level " + to_string(levelN) + " solution line " + to_string(lineN)
 						+ ": found " + (switchIsMilestone ? "milestone" : "non-milestone")
 						+ ", expected " + (expectMilestoneSwitch ? "milestone" : "non-milestone") + ": \"" + line + "\"");
+				verified = false;
 			}
 
 			//we found the switch, so go to it and kick it and advance to the next step
@@ -1972,17 +2090,20 @@ int Level::clearPotentialLevelStateHolders() {
 				Logger::debugLogger.logString(
 					"ERROR: level " + to_string(levelN) + " solution line " + to_string(lineN)
 						+ ": kicking switch resulted in old state: \"" + line + "\"");
+				verified = false;
 				break;
 			}
 		}
 
-		if (line != "end")
+		if (line != "end") {
 			Logger::debugLogger.logString(
 				"ERROR: level " + to_string(levelN) + " solution: missing \"end\"");
-		else if (statesAtSolutionStep.empty() || statesAtSolutionStep.front()->plane != victoryPlane)
+			verified = false;
+		} else if (statesAtSolutionStep.empty() || statesAtSolutionStep.front()->plane != victoryPlane) {
 			Logger::debugLogger.logString(
 				"ERROR: level " + to_string(levelN) + " solution: unable to reach victory plane after all steps");
-		else {
+			verified = false;
+		} else {
 			#ifdef LOG_FOUND_HINT_STEPS
 				statesAtSolutionStep.front()->logSteps();
 			#endif
@@ -1994,6 +2115,108 @@ int Level::clearPotentialLevelStateHolders() {
 					+ to_string(foundHintSearchTotalSteps) + "(" + to_string(foundHintSearchTotalHintSteps) + ")" + " steps");
 		}
 		clearPotentialLevelStateHolders();
+		return verified;
+	}
+	void Level::openSolutionsFile(ifstream& file) {
+		string filename = "test_solutions/" + to_string(levelN) + ".txt";
+		FileUtils::openFileForRead(&file, filename.c_str(), FileUtils::FileReadLocation::Installation);
+	}
+	void Level::addSolutionTests(vector<SolutionTest>& solutionTests) {
+		if (victoryPlane == nullptr)
+			return;
+		ifstream file;
+		openSolutionsFile(file);
+		//solutions are named by the comment right before them
+		string solutionName;
+		string line;
+		for (int lineN = 1; getline(file, line); lineN++) {
+			if (StringUtils::startsWith(line, "#"))
+				solutionName = line.c_str() + 1;
+			else if (line == "start")
+				solutionTests.push_back(SolutionTest(this, solutionName, lineN));
+		}
+		file.close();
+	}
+	bool Level::testSolutionAtLine(int startLineN) {
+		ifstream file;
+		openSolutionsFile(file);
+		string line;
+		int lineN = 0;
+		while (lineN < startLineN && getline(file, line))
+			lineN++;
+		bool verified = testSolution(getInitialRailState, file, lineN);
+		file.close();
+		return verified;
+	}
+	int Level::testAllSolutions(vector<Level*>& allLevels) {
+		vector<SolutionTest> solutionTests;
+		for (Level* level : allLevels)
+			level->addSolutionTests(solutionTests);
+
+		//every thread pulls the next untested solution until they've all been tested, using as many threads as we have cores
+		int threadCount = MathUtils::max(1, MathUtils::min((int)thread::hardware_concurrency(), (int)solutionTests.size()));
+		mutex solutionTestsMutex;
+		int nextSolutionTestI = 0;
+		auto testSolutionsOnThread = [&solutionTests, &solutionTestsMutex, &nextSolutionTestI]() {
+			//setting up log queues doesn't lock, so we need to do it ourselves
+			solutionTestsMutex.lock();
+			Logger::setupLogQueue("T");
+			solutionTestsMutex.unlock();
+			setupThreadHintSearchHelpers();
+			while (true) {
+				solutionTestsMutex.lock();
+				int solutionTestI = nextSolutionTestI++;
+				solutionTestsMutex.unlock();
+				if (solutionTestI >= (int)solutionTests.size())
+					break;
+				SolutionTest& solutionTest = solutionTests[solutionTestI];
+				int startTicksTime = (int)SDL_GetTicks();
+				solutionTest.verified = solutionTest.level->testSolutionAtLine(solutionTest.startLineN);
+				solutionTest.ticksDuration = (int)SDL_GetTicks() - startTicksTime;
+			}
+			deleteHelpers();
+			solutionTestsMutex.lock();
+			Logger::markLogQueueUnused();
+			solutionTestsMutex.unlock();
+		};
+		int startTicksTime = (int)SDL_GetTicks();
+		vector<thread*> solutionTestThreads;
+		for (int i = 0; i < threadCount; i++)
+			solutionTestThreads.push_back(new thread(testSolutionsOnThread));
+		for (thread* solutionTestThread : solutionTestThreads) {
+			solutionTestThread->join();
+			delete solutionTestThread;
+		}
+		int totalTicksDuration = (int)SDL_GetTicks() - startTicksTime;
+
+		//log the results of each level
+		int failedSolutionsCount = 0;
+		for (int i = 0; i < (int)solutionTests.size(); ) {
+			Level* level = solutionTests[i].level;
+			int levelSolutionsCount = 0;
+			int levelFailedSolutionsCount = 0;
+			int levelTicksDuration = 0;
+			stringstream levelMessage;
+			for (; i < (int)solutionTests.size() && solutionTests[i].level == level; i++) {
+				SolutionTest& solutionTest = solutionTests[i];
+				levelSolutionsCount++;
+				levelTicksDuration += solutionTest.ticksDuration;
+				levelMessage << "  " << solutionTest.name << " " << solutionTest.ticksDuration << "ms";
+				if (!solutionTest.verified) {
+					levelFailedSolutionsCount++;
+					levelMessage << " FAILED";
+				}
+			}
+			failedSolutionsCount += levelFailedSolutionsCount;
+			Logger::debugLogger.logString(
+				(levelFailedSolutionsCount > 0 ? "ERROR: level " : "level ") + to_string(level->levelN) + ": "
+					+ to_string(levelSolutionsCount - levelFailedSolutionsCount) + "/" + to_string(levelSolutionsCount)
+					+ " solutions verified in " + to_string(levelTicksDuration) + "ms:" + levelMessage.str());
+		}
+		Logger::debugLogger.logString(
+			"tested " + to_string(solutionTests.size()) + " solutions on " + to_string(threadCount) + " threads in "
+				+ to_string(totalTicksDuration) + "ms, " + to_string(failedSolutionsCount) + " failed");
+		return failedSolutionsCount;
 	}
 #endif
 deque<HintState::PotentialLevelState*>* Level::getNextPotentialLevelStatesForSteps(int nextPotentialLevelStateSteps) {
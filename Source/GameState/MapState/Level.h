@@ -17,6 +17,8 @@ class Switch;
 class ResetSwitch;
 
 namespace LevelTypes {
+	class Plane;
+
 	//Should only be allocated within an object, on the stack, or as a static object
 	class RailByteMaskData {
 	public:
@@ -52,6 +54,31 @@ namespace LevelTypes {
 		RailByteMaskData(Rail* pRail, short pRailId, ByteMask pRailBits);
 		virtual ~RailByteMaskData();
 	};
+	//Should only be allocated within an object, on the stack, or as a static object
+	//a flattened copy of all the plane connections in a level, compiled after the level is finalized, so that hint searches
+	//	can read connections sequentially instead of going through each plane
+	class ConnectionGraph {
+	public:
+		//connections from the plane at index i are at indices planeConnectionsStart[i] through
+		//	planeConnectionsStart[i + 1] - 1
+		vector<int> planeConnectionsStart;
+		vector<int> connectionToPlaneIndices;
+		//plane-plane connections use byte index 0 with an empty byte mask so that they always pass the lowered-rail check
+		vector<char> connectionRailByteIndices;
+		vector<unsigned int> connectionRailTileOffsetByteMasks;
+		vector<int> connectionSteps;
+		vector<char> planeCanVisitByteIndices;
+		vector<unsigned int> planeCanVisitByteMasks;
+		//planes without a milestoneIsNewBit use byte index 0 with an empty byte mask so that they never pass the check
+		vector<char> planeMilestoneIsNewByteIndices;
+		vector<unsigned int> planeMilestoneIsNewByteMasks;
+		//side tables, only read once a connection reaches a plane in fewer steps
+		vector<Hint*> connectionHints;
+		vector<Plane*> planes;
+
+		ConnectionGraph();
+		virtual ~ConnectionGraph();
+	};
 	class Plane onlyInDebug(: public ObjCounter) {
 	private:
 		struct DetailedConnectionSwitch;
@@ -173,16 +200,45 @@ namespace LevelTypes {
 			vector<vector<DetailedRail>> rails;
 			vector<DetailedConnectionSwitch*> allConnectionSwitches;
 			DetailedPlane* victoryPlane;
+			//scratch buffers for path-walks, reused between walks so that they don't need to allocate anything
+			//pathWalkNextConnectionIndices is the explicit DFS stack, tracking where to resume searching each plane in the path
+			vector<bool> pathWalkSeenPlanes;
+			vector<int> pathWalkNextConnectionIndices;
+			vector<DetailedPlane*> scratchPathPlanes;
+			vector<DetailedConnection*> scratchPathConnections;
+			vector<bool> scratchPlaneFlags;
+			vector<unsigned int> scratchRailByteMasks;
 
 		public:
 			DetailedLevel(Level* pLevel, vector<Plane*>& levelPlanes);
 			virtual ~DetailedLevel();
 
 		private:
+			//path-walk visitors, passed by value so that path-walks can inline them
 			//indicates that a path-walk should not exclude any connections
-			static bool excludeZeroConnections(DetailedConnection* connection) { return false; }
+			struct ExcludeZeroConnections {
+				bool operator()(DetailedConnection* connection) { return false; }
+			};
+			//indicates that a path-walk should exclude rail connections
+			struct ExcludeRailConnections {
+				bool operator()(DetailedConnection* connection) { return connection->switchRail != nullptr; }
+			};
+			//indicates that a path-walk should exclude the given connection
+			struct ExcludeSingleConnection {
+				DetailedConnection* excludedConnection;
+
+				bool operator()(DetailedConnection* connection) { return connection == excludedConnection; }
+			};
+			//indicates that a path-walk should exclude connections that match the given rail byte masks
+			struct ExcludeRailByteMasks {
+				vector<unsigned int>* railByteMasks;
+
+				bool operator()(DetailedConnection* connection);
+			};
 			//indicates that a path-walk should accept all paths
-			static bool alwaysAcceptPath() { return true; }
+			struct AcceptAllPaths {
+				bool operator()() { return true; }
+			};
 			//get a DetailedRail for the given RailByteMaskData, creating it if necessary
 			//the returned value should not be stored until every rail in the level has been created
 			DetailedRail* getDetailedRail(RailByteMaskData* railByteMaskData);
@@ -193,9 +249,12 @@ namespace LevelTypes {
 			//must be called before extending connections or removing connections to non-victory planes without switches
 			void findMilestones(RailByteMaskData::ByteMask alwaysOnBit);
 		private:
-			//find all connections that must be crossed in order to get to the given plane from the start plane
-			vector<DetailedConnection*> findRequiredConnectionsToPlane(
-				DetailedPlane* destination, bool excludeConnectionsFromSwitchesOnDestination);
+			//find all connections that must be crossed in order to get to the given plane from the start plane, and write
+			//	them to outRequiredConnections
+			void findRequiredConnectionsToPlane(
+				DetailedPlane* destination,
+				bool excludeConnectionsFromSwitchesOnDestination,
+				vector<DetailedConnection*>& outRequiredConnections);
 			//search for paths to every remaining plane until we reach the given plane, without going through any excluded
 			//	connections or connections that require access to switches on the given plane
 			//assumes there is at least one plane in inOutPathPlanes, and starts the walk from the end of the path described by
@@ -210,20 +269,14 @@ namespace LevelTypes {
 			//	- inOutPathPlanes and inOutPathConnections will contain the path as it existed when that happened
 			//- false if we never reached the given plane or checkPath() never returned true after doing so
 			//	- inOutPathPlanes and inOutPathConnections will contain their original contents
-			bool pathWalkToPlane(
+			//must not be called from within checkPath(), since it uses this DetailedLevel's path-walk scratch buffers
+			template <class ExcludeConnection, class CheckPath> bool pathWalkToPlane(
 				DetailedPlane* destination,
 				bool excludeConnectionsFromSwitchesOnDestination,
-				function<bool(DetailedConnection* connection)> excludeConnection,
+				ExcludeConnection excludeConnection,
 				vector<DetailedPlane*>& inOutPathPlanes,
 				vector<DetailedConnection*>& inOutPathConnections,
-				function<bool()> checkPath);
-			//indicates that a path-walk should exclude rail connections
-			static bool excludeRailConnections(DetailedConnection* connection);
-			//indicates that a path-walk should exclude the given connection
-			static function<bool(DetailedConnection* connection)> excludeSingleConnection(
-				DetailedConnection* excludedConnection);
-			//indicates that a path-walk should exclude connections that match the given rail byte masks
-			static function<bool(DetailedConnection* connection)> excludeRailByteMasks(vector<unsigned int>& railByteMasks);
+				CheckPath checkPath);
 		public:
 			//find sets of 2 or more switches that have rails in common
 			//must be called after setting default bits and before extending connections or removing connections to non-victory
@@ -232,8 +285,8 @@ namespace LevelTypes {
 		private:
 			//find all planes that are reachable or unreachable when certain connections are excluded, and write them to
 			//	outReachablePlanes or outUnreachablePlanes respectively, if provided
-			void findReachablePlanes(
-				function<bool(DetailedConnection* connection)> excludeConnection,
+			template <class ExcludeConnection> void findReachablePlanes(
+				ExcludeConnection excludeConnection,
 				vector<DetailedPlane*>* outReachablePlanes,
 				vector<DetailedPlane*>* outUnreachablePlanes);
 			//see if the given mini puzzle is part of an area with a single entrance and exit, and if so, track it
@@ -318,6 +371,9 @@ namespace LevelTypes {
 		//must be called after assigning can-visit bits
 		void removeEmptyPlaneConnections(short alwaysOffBitId);
 	public:
+		//flatten the connections of all the given planes into the given connection graph
+		//must be called after all connections have been finalized
+		static void compileConnectionGraph(vector<Plane*>& levelPlanes, ConnectionGraph* outConnectionGraph);
 		//set bits in the draft state where applicable:
 		//- set bits where milestones are new
 		//- set bits where switches can be kicked
@@ -424,6 +480,20 @@ private:
 			LevelTypes::RailByteMaskData::ByteMask pSharedAbandonBit);
 		virtual ~IsolatedArea();
 	};
+	#ifdef TEST_SOLUTIONS
+		//Should only be allocated within an object, on the stack, or as a static object
+		class SolutionTest {
+		public:
+			Level* level;
+			string name;
+			int startLineN;
+			bool verified;
+			int ticksDuration;
+
+			SolutionTest(Level* pLevel, string& pName, int pStartLineN);
+			virtual ~SolutionTest();
+		};
+	#endif
 
 public:
 	static constexpr char absentRailByteIndex = -1;
@@ -436,39 +506,45 @@ public:
 
 	static LevelTypes::RailByteMaskData::ByteMask absentBits;
 private:
-	static bool hintSearchIsRunning;
+	//set to stop any in-progress hint search; searches only read it, it's cleared before starting a search thread so that a
+	//	cancel issued before the search begins still applies
+	static atomic<bool> hintSearchCanceled;
+	static int maxHintSearchPlaneCount;
+	//every thread that runs a hint search has its own copy of the hint search helpers, so that searches can run on several
+	//	threads at once
 public:
-	static vector<PotentialLevelStatesByBucket> potentialLevelStatesByBucketByPlane;
-	static vector<HintState::PotentialLevelState*> replacedPotentialLevelStates;
-	static short cachedAlwaysOnBitId;
-	static LevelTypes::Plane*** allCheckPlanes;
-	static int* checkPlaneCounts;
-	static CheckedPlaneData* checkedPlaneDatas;
-	static int* checkedPlaneIndices;
+	static thread_local vector<PotentialLevelStatesByBucket> potentialLevelStatesByBucketByPlane;
+	static thread_local vector<HintState::PotentialLevelState*> replacedPotentialLevelStates;
+	static thread_local short cachedAlwaysOnBitId;
+	static thread_local LevelTypes::Plane*** allCheckPlanes;
+	static thread_local int* checkPlaneCounts;
+	static thread_local CheckedPlaneData* checkedPlaneDatas;
+	static thread_local int* checkedPlaneIndices;
 private:
-	static int currentPotentialLevelStateSteps;
-	static vector<int> currentPotentialLevelStateStepsForMilestones;
-	static int maxPotentialLevelStateSteps;
-	static vector<int> maxPotentialLevelStateStepsForMilestones;
-	static int currentMilestones;
-	static deque<HintState::PotentialLevelState*>* currentNextPotentialLevelStates;
-	static vector<deque<HintState::PotentialLevelState*>*>* currentNextPotentialLevelStatesBySteps;
-	static vector<vector<deque<HintState::PotentialLevelState*>*>> nextPotentialLevelStatesByStepsByMilestone;
-	static int hintSearchCheckStateI;
-	static LevelTypes::Plane* cachedHintSearchVictoryPlane;
+	static thread_local int currentPotentialLevelStateSteps;
+	static thread_local vector<int> currentPotentialLevelStateStepsForMilestones;
+	static thread_local int maxPotentialLevelStateSteps;
+	static thread_local vector<int> maxPotentialLevelStateStepsForMilestones;
+	static thread_local int currentMilestones;
+	static thread_local deque<HintState::PotentialLevelState*>* currentNextPotentialLevelStates;
+	static thread_local vector<deque<HintState::PotentialLevelState*>*>* currentNextPotentialLevelStatesBySteps;
+	static thread_local vector<vector<deque<HintState::PotentialLevelState*>*>>
+		nextPotentialLevelStatesByStepsByMilestone;
+	static thread_local int hintSearchCheckStateI;
+	static thread_local LevelTypes::Plane* cachedHintSearchVictoryPlane;
 	#ifdef LOG_SEARCH_STEPS_STATS
-		static int* statesAtStepsByPlane;
-		static int* statesAtStepsFromPlane;
+		static thread_local int* statesAtStepsByPlane;
+		static thread_local int* statesAtStepsFromPlane;
 	#endif
-	static bool enableHintSearchTimeout;
+	static thread_local bool enableHintSearchTimeout;
 public:
 	#ifdef TRACK_HINT_SEARCH_STATS
-		static int hintSearchActionsChecked;
-		static int hintSearchComparisonsPerformed;
+		static thread_local int hintSearchActionsChecked;
+		static thread_local int hintSearchComparisonsPerformed;
 	#endif
-	static int foundHintSearchTotalHintSteps;
+	static thread_local int foundHintSearchTotalHintSteps;
 private:
-	static int foundHintSearchTotalSteps;
+	static thread_local int foundHintSearchTotalSteps;
 
 	int levelN;
 	int startTile;
@@ -484,6 +560,9 @@ private:
 	Hint radioTowerHint;
 	Hint undoResetHint;
 	Hint searchCanceledEarlyHint;
+	//written by the hint prefetch thread and read on the update thread
+	atomic<Hint*> startStateHint;
+	LevelTypes::ConnectionGraph connectionGraph;
 
 public:
 	Level(objCounterParametersComma() int pLevelN, int pStartTile);
@@ -494,6 +573,7 @@ public:
 	LevelTypes::RailByteMaskData* getRailByteMaskData(int i) { return &allRailByteMaskData[i]; }
 	int getRailByteMaskCount() { return (railByteMaskBitsTracked + 31) / 32; }
 	LevelTypes::Plane* getVictoryPlane() { return victoryPlane; }
+	LevelTypes::ConnectionGraph* getConnectionGraph() { return &connectionGraph; }
 	int getPlanesCount() { return (int)planes.size(); }
 	void trackPassThroughMiniPuzzle(
 		vector<LevelTypes::RailByteMaskData*>& passThroughRails, LevelTypes::RailByteMaskData::ByteMask miniPuzzleBit)
@@ -507,7 +587,10 @@ public:
 	{
 		allIsolatedAreas.push_back(IsolatedArea(goalSwitchCanKickBits, abandonCanUseBits, sharedAbandonBit));
 	}
-	static void cancelHintSearch() { hintSearchIsRunning = false; }
+	//allow hint searches to run until the next call to cancelHintSearch()
+	//should be called before starting the thread that runs a hint search
+	static void allowHintSearch() { hintSearchCanceled = false; }
+	static void cancelHintSearch() { hintSearchCanceled = true; }
 	//add a new plane to this level
 	LevelTypes::Plane* addNewPlane();
 	//add a special plane for use as the victory plane
@@ -523,13 +606,30 @@ public:
 	LevelTypes::RailByteMaskData::ByteMask trackRailByteMaskBits(int nBits);
 	//finish setup of this level
 	void finalizeBuilding();
-	//setup helper objects used by all levels in hint searching
+	//find the sizes of the helper objects used by all levels in hint searching
 	static void setupHintSearchHelpers(vector<Level*>& allLevels);
-	//delete helpers used in hint searching
+	//setup helper objects used in hint searching on this thread
+	//every thread must call this before running a hint search
+	static void setupThreadHintSearchHelpers();
+	//delete helpers used in hint searching on this thread
 	static void deleteHelpers();
-	//generate a hint to solve this level from the start, to save time in the future allocating PotentialLevelStates when
-	//	generating hints
-	void preAllocatePotentialLevelStates();
+	#ifdef TEST_SOLUTIONS
+		//test every solution of every given level, spread across as many threads as we can use, and log the timing of each
+		//	level
+		//returns how many solutions failed
+		static int testAllSolutions(vector<Level*>& allLevels);
+	#endif
+private:
+	//write the initial state of the given rail
+	static void getInitialRailState(short railId, Rail* rail, char* outMovementDirection, char* outTileOffset);
+public:
+	//generate a hint to solve this level from the start and cache it, which also saves time in the future allocating
+	//	PotentialLevelStates when generating hints
+	//returns whether the search finished without being canceled
+	bool prefetchStartStateHint();
+	//if the given state matches the start state of this level and its hint has been prefetched, return that hint
+	//otherwise, returns nullptr
+	Hint* getStartStateHint(LevelTypes::Plane* currentPlane, GetRailState getRailState, char lastActivatedSwitchColor);
 	#ifdef DEBUG
 		//validate that the reset switch resets all the switches of this level, and no more
 		void validateResetSwitch();
@@ -553,7 +653,15 @@ private:
 		//load the solution file for this level and test that the solutions in it follow a valid path to the victory plane
 		void testSolutions(GetRailState getRailState);
 		//read steps from the input and test that they follow a valid path to the victory plane
-		void testSolution(GetRailState getRailState, ifstream& file, int& lineN);
+		//returns whether the solution was verified
+		bool testSolution(GetRailState getRailState, ifstream& file, int& lineN);
+		//open the solution file for this level
+		void openSolutionsFile(ifstream& file);
+		//find every solution in the solution file for this level and add a test for it
+		void addSolutionTests(vector<SolutionTest>& solutionTests);
+		//test the solution at the given line in the solution file for this level
+		//returns whether the solution was verified
+		bool testSolutionAtLine(int startLineN);
 	#endif
 public:
 	//get the queue of next potential level states corresponding to the given steps
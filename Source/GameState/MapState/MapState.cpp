@@ -45,11 +45,21 @@ MapState::PlaneConnectionSwitch::~PlaneConnectionSwitch() {
 	//don't delete the plane, it's owned by a Level
 }
 
+//////////////////////////////// MapState::StateChanges ////////////////////////////////
+MapState::StateChanges::StateChanges(int pPreviousRevision)
+: previousRevision(pPreviousRevision)
+, railIndices()
+, switchIndices()
+, resetSwitchIndices() {
+}
+MapState::StateChanges::~StateChanges() {}
+
 //////////////////////////////// MapState ////////////////////////////////
 char* MapState::tiles = nullptr;
 char* MapState::tileBorders = nullptr;
 char* MapState::heights = nullptr;
 short* MapState::railSwitchIds = nullptr;
+char* MapState::tileFallOffsets = nullptr;
 short* MapState::planeIds = nullptr;
 char* MapState::mapZeroes = nullptr;
 vector<Rail*> MapState::rails;
@@ -57,11 +67,38 @@ vector<Switch*> MapState::switches;
 vector<ResetSwitch*> MapState::resetSwitches;
 vector<LevelTypes::Plane*> MapState::planes;
 vector<Level*> MapState::levels;
+short MapState::switchIndicesByColorAndGroup[colorCount * groupCount];
+vector<short> MapState::railIndicesByColorAndGroup[colorCount * groupCount];
 int MapState::mapWidth = 1;
 int MapState::mapHeight = 1;
+vector<shared_ptr<vector<GLfloat>>> MapState::floorChunkQuads;
+atomic<bool>* MapState::floorChunksDirty = nullptr;
+int MapState::floorChunksWidth = 0;
+bool MapState::floorChunksShowBlockedFallEdges = false;
+vector<shared_ptr<vector<GLfloat>>> MapState::floorChunkShadingQuads;
+char* MapState::floorChunkShadingHeights = nullptr;
+int MapState::floorChunksShadingMode = MapState::editorFloorShadingMode;
+vector<vector<short>> MapState::railIndicesByFloorChunk;
+vector<short> MapState::renderRailIndices;
+vector<short> MapState::railRenderPositions;
+vector<short> MapState::groupRenderRailIndices;
+vector<vector<short>> MapState::switchIndicesByFloorChunk;
+vector<vector<short>> MapState::resetSwitchIndicesByFloorChunk;
+atomic<bool> MapState::switchIndicesByFloorChunkDirty (false);
+vector<short> MapState::renderSwitchIndices;
+vector<short> MapState::renderResetSwitchIndices;
 bool MapState::editorHideNonTiles = false;
+atomic<bool> MapState::hintPrefetchIsRunning (false);
+atomic<int> MapState::prefetchedStartStateHintsCount (0);
+deque<MapState::StateChanges> MapState::stateChangesByRevision;
+int MapState::firstTrackedRevision = 0;
 MapState::MapState(objCounterParameters())
 : PooledReferenceCounter(objCounterArguments())
+, revision(-1)
+, statesRevision(-1)
+, lastUpdateTicksTime(0)
+, activeRailIndices()
+, railIsActive()
 , railStates()
 , switchStates()
 , resetSwitchStates()
@@ -72,6 +109,7 @@ MapState::MapState(objCounterParameters())
 , finishedMapCameraTutorial(false)
 //prevent the switches fade-in animation from playing on load by ensuring tick 0 is after the fade-in is over
 , switchesAnimationFadeInStartTicksTime(-switchesFadeInDuration)
+, switchFlipsEndTicksTime(0)
 , shouldPlayRadioTowerAnimation(false)
 , particles()
 , waveformStartTicksTime(0)
@@ -95,11 +133,12 @@ MapState::MapState(objCounterParameters())
 			switchStatesByGroup.push_back(nullptr);
 		switchStatesByGroup[group] = switchState;
 	}
-	for (RailState* railState : railStates) {
+	for (int i = 0; i < (int)railStates.size(); i++) {
+		RailState* railState = railStates[i];
 		Rail* rail = railState->getRail();
 		vector<SwitchState*>& switchStatesByGroup = switchStatesByGroupByColor[rail->getColor()];
 		for (char group : railState->getRail()->getGroups())
-			switchStatesByGroup[group]->addConnectedRailState(railState);
+			switchStatesByGroup[group]->addConnectedRailState(railState, i);
 	}
 }
 MapState::~MapState() {
@@ -113,6 +152,11 @@ MapState::~MapState() {
 MapState* MapState::produce(objCounterParameters()) {
 	initializeWithNewFromPool(m, MapState)
 	m->hintState.set(newHintState(&Hint::none, 0));
+	//our states still match our old revision until we update them
+	m->statesRevision = m->revision;
+	m->revision = trackNewRevision();
+	//a pooled map state may still list the rails that were active for its previous owner
+	m->clearActiveRails();
 	return m;
 }
 pooledReferenceCounterDefineRelease(MapState)
@@ -129,6 +173,7 @@ void MapState::buildMap() {
 	tileBorders = new char[totalTiles];
 	heights = new char[totalTiles];
 	railSwitchIds = new short[totalTiles];
+	tileFallOffsets = new char[totalTiles * floorHeightCount];
 	mapZeroes = new char[totalTiles];
 
 	int redShift = (int)floor->format->Rshift;
@@ -225,6 +270,10 @@ void MapState::buildMap() {
 		}
 	}
 
+	//heights are final, precompute where the player lands when falling from any tile
+	for (int x = 0; x < mapWidth; x++)
+		buildTileFallOffsets(x);
+
 	for (int i = 0; i < totalTiles; i++) {
 		int height = heights[i];
 		if (height == emptySpaceHeight || height % 2 != 0)
@@ -249,6 +298,22 @@ void MapState::buildMap() {
 
 	SDL_FreeSurface(floor);
 
+	buildColorAndGroupIndex();
+
+	//the floor chunks get built when they're first rendered
+	floorChunksWidth = (mapWidth + floorChunkTileSize - 1) / floorChunkTileSize;
+	int floorChunksCount = floorChunksWidth * ((mapHeight + floorChunkTileSize - 1) / floorChunkTileSize);
+	floorChunkQuads.resize(floorChunksCount);
+	floorChunksDirty = new atomic<bool>[floorChunksCount];
+	for (int i = 0; i < floorChunksCount; i++)
+		floorChunksDirty[i] = true;
+	floorChunkShadingQuads.resize(floorChunksCount);
+	floorChunkShadingHeights = new char[floorChunksCount];
+	for (int i = 0; i < floorChunksCount; i++)
+		floorChunkShadingHeights[i] = invalidHeight;
+	buildRailIndicesByFloorChunk();
+	buildSwitchIndicesByFloorChunk();
+
 	//link reset switches to their affected rails
 	for (int i = 0; i < (int)rails.size(); i++) {
 		Rail* rail = rails[i];
@@ -269,6 +334,186 @@ void MapState::buildMap() {
 	} else
 		buildLevels();
 }
+void MapState::buildColorAndGroupIndex() {
+	for (int i = 0; i < colorCount * groupCount; i++) {
+		switchIndicesByColorAndGroup[i] = -1;
+		railIndicesByColorAndGroup[i].clear();
+	}
+	for (int i = 0; i < (int)switches.size(); i++) {
+		Switch* switch0 = switches[i];
+		if (!switch0->editorIsDeleted)
+			switchIndicesByColorAndGroup[switch0->getColor() * groupCount + switch0->getGroup()] = (short)i;
+	}
+	for (int i = 0; i < (int)rails.size(); i++) {
+		Rail* rail = rails[i];
+		if (rail->editorIsDeleted)
+			continue;
+		for (char group : rail->getGroups()) {
+			vector<short>& railIndices = railIndicesByColorAndGroup[rail->getColor() * groupCount + group];
+			//a rail only needs to be listed once per group
+			if (railIndices.empty() || railIndices.back() != (short)i)
+				railIndices.push_back((short)i);
+		}
+	}
+}
+void MapState::invalidateFloorChunk(int x, int y) {
+	floorChunksDirty[y / floorChunkTileSize * floorChunksWidth + x / floorChunkTileSize] = true;
+}
+void MapState::buildFloorChunk(int chunkX, int chunkY, char* useTileBorders) {
+	shared_ptr<vector<GLfloat>> quads = make_shared<vector<GLfloat>>();
+	floorChunkQuads[chunkY * floorChunksWidth + chunkX] = quads;
+	//the heights in this chunk may have changed too
+	floorChunkShadingHeights[chunkY * floorChunksWidth + chunkX] = invalidHeight;
+	int tileMinX = chunkX * floorChunkTileSize;
+	int tileMinY = chunkY * floorChunkTileSize;
+	int tileMaxX = MathUtils::min(tileMinX + floorChunkTileSize, mapWidth);
+	int tileMaxY = MathUtils::min(tileMinY + floorChunkTileSize, mapHeight);
+	for (int y = tileMinY; y < tileMaxY; y++) {
+		for (int x = tileMinX; x < tileMaxX; x++) {
+			//consider any tile at the max height to be filler
+			int mapIndex = y * mapWidth + x;
+			if (heights[mapIndex] == emptySpaceHeight)
+				continue;
+			GLfloat leftX = (GLfloat)(x * tileSize);
+			GLfloat topY = (GLfloat)(y * tileSize);
+			SpriteRegistry::tiles->addSpriteQuad(
+				quads.get(), (int)(tiles[mapIndex]), (int)(useTileBorders[mapIndex]), leftX, topY);
+		}
+	}
+}
+void MapState::buildFloorChunkShading(int chunkX, int chunkY, char referenceHeight) {
+	int chunkIndex = chunkY * floorChunksWidth + chunkX;
+	shared_ptr<vector<GLfloat>> quads = make_shared<vector<GLfloat>>();
+	floorChunkShadingQuads[chunkIndex] = quads;
+	floorChunkShadingHeights[chunkIndex] = referenceHeight;
+
+	//figure out the shading for every height first
+	GLfloat heightColors[heightCount];
+	GLfloat heightAlphas[heightCount];
+	if (floorChunksShadingMode == editorFloorShadingMode) {
+		//darken tiles that don't match the selected height
+		for (int height = 0; height < heightCount; height++) {
+			heightColors[height] = 0.0f;
+			heightAlphas[height] = height == referenceHeight ? 0.0f : 0.5f;
+		}
+	} else {
+		static constexpr int nearHeightsEnd = 4;
+		//even distribution from 0%-50% across floor height differences 0-7
+		float maxAlpha = 0.5f;
+		float nearHeightsMaxAlpha = maxAlpha * nearHeightsEnd / highestFloorHeight;
+		if (floorChunksShadingMode == Config::heightBasedShadingExtraValue) {
+			//distribute 0%-25% across floor height differences 0-n, and 25%-62.5% across floor height differences n-7
+			nearHeightsMaxAlpha = 0.25f;
+			maxAlpha = 0.625f;
+		}
+		float nearHeightsMultiplier = nearHeightsMaxAlpha / nearHeightsEnd;
+		float farHeightsMultiplier = (maxAlpha - nearHeightsMaxAlpha) / (highestFloorHeight - nearHeightsEnd);
+		//tiles above the player are lightened, tiles below the player are darkened
+		for (int height = 0; height < heightCount; height++) {
+			int heightDifference = abs(height - referenceHeight);
+			heightColors[height] = height > referenceHeight ? 1.0f : 0.0f;
+			heightAlphas[height] = heightDifference <= nearHeightsEnd
+				? heightDifference * nearHeightsMultiplier
+				: (heightDifference - nearHeightsEnd) * farHeightsMultiplier + nearHeightsMaxAlpha;
+		}
+	}
+	//consider any tile at the max height to be filler
+	heightAlphas[emptySpaceHeight] = 0.0f;
+
+	//shade each row in runs of tiles with the same height, so that most rows only need a few rectangles
+	int tileMinX = chunkX * floorChunkTileSize;
+	int tileMinY = chunkY * floorChunkTileSize;
+	int tileMaxX = MathUtils::min(tileMinX + floorChunkTileSize, mapWidth);
+	int tileMaxY = MathUtils::min(tileMinY + floorChunkTileSize, mapHeight);
+	for (int y = tileMinY; y < tileMaxY; y++) {
+		int runEndX;
+		for (int x = tileMinX; x < tileMaxX; x = runEndX) {
+			char height = heights[y * mapWidth + x];
+			runEndX = x + 1;
+			while (runEndX < tileMaxX && heights[y * mapWidth + runEndX] == height)
+				runEndX++;
+			if (heightAlphas[height] == 0.0f)
+				continue;
+			GLfloat color = heightColors[height];
+			SpriteSheet::addRectangleQuad(
+				quads.get(),
+				color,
+				color,
+				color,
+				heightAlphas[height],
+				(GLfloat)(x * tileSize),
+				(GLfloat)(y * tileSize),
+				(GLfloat)(runEndX * tileSize),
+				(GLfloat)((y + 1) * tileSize));
+		}
+	}
+}
+void MapState::buildRailIndicesByFloorChunk() {
+	railIndicesByFloorChunk.clear();
+	railIndicesByFloorChunk.resize(floorChunkQuads.size());
+	for (int i = 0; i < (int)rails.size(); i++) {
+		Rail* rail = rails[i];
+		addIndexToFloorChunks(
+			railIndicesByFloorChunk,
+			(short)i,
+			rail->getRenderLeftTileX(),
+			rail->getRenderTopTileY(),
+			rail->getRenderRightTileX(),
+			rail->getRenderBottomTileY());
+	}
+}
+void MapState::buildSwitchIndicesByFloorChunk() {
+	switchIndicesByFloorChunk.clear();
+	switchIndicesByFloorChunk.resize(floorChunkQuads.size());
+	for (int i = 0; i < (int)switches.size(); i++) {
+		Switch* switch0 = switches[i];
+		int leftX = switch0->getLeftX();
+		int topY = switch0->getTopY();
+		addIndexToFloorChunks(switchIndicesByFloorChunk, (short)i, leftX, topY, leftX + 2, topY + 2);
+	}
+	resetSwitchIndicesByFloorChunk.clear();
+	resetSwitchIndicesByFloorChunk.resize(floorChunkQuads.size());
+	for (int i = 0; i < (int)resetSwitches.size(); i++) {
+		int leftTileX, topTileY, rightTileX, bottomTileY;
+		resetSwitches[i]->getRenderTileBounds(&leftTileX, &topTileY, &rightTileX, &bottomTileY);
+		addIndexToFloorChunks(resetSwitchIndicesByFloorChunk, (short)i, leftTileX, topTileY, rightTileX, bottomTileY);
+	}
+}
+void MapState::addIndexToFloorChunks(
+	vector<vector<short>>& indicesByFloorChunk, short index, int leftTileX, int topTileY, int rightTileX, int bottomTileY)
+{
+	//render bounds may extend past the bottom of the map, for rails that can be lowered
+	int chunkMinX = leftTileX / floorChunkTileSize;
+	int chunkMinY = topTileY / floorChunkTileSize;
+	int chunkMaxX = MathUtils::min(rightTileX - 1, mapWidth - 1) / floorChunkTileSize;
+	int chunkMaxY = MathUtils::min(bottomTileY - 1, mapHeight - 1) / floorChunkTileSize;
+	for (int chunkY = chunkMinY; chunkY <= chunkMaxY; chunkY++) {
+		for (int chunkX = chunkMinX; chunkX <= chunkMaxX; chunkX++)
+			indicesByFloorChunk[chunkY * floorChunksWidth + chunkX].push_back(index);
+	}
+}
+void MapState::collectFloorChunkIndices(
+	vector<vector<short>>& indicesByFloorChunk,
+	int chunkMinX,
+	int chunkMinY,
+	int chunkMaxX,
+	int chunkMaxY,
+	int indexCount,
+	vector<short>* outIndices)
+{
+	outIndices->clear();
+	for (int chunkY = chunkMinY; chunkY <= chunkMaxY; chunkY++) {
+		for (int chunkX = chunkMinX; chunkX <= chunkMaxX; chunkX++) {
+			for (short index : indicesByFloorChunk[chunkY * floorChunksWidth + chunkX]) {
+				if (index < indexCount)
+					outIndices->push_back(index);
+			}
+		}
+	}
+	//anything that spans multiple chunks was added once per chunk, and sorting keeps the original render order
+	sort(outIndices->begin(), outIndices->end());
+	outIndices->erase(unique(outIndices->begin(), outIndices->end()), outIndices->end());
+}
 vector<int> MapState::parseRail(int* pixels, int redShift, int segmentIndex, int railSwitchId) {
 	//cache shift values so that we can iterate the floor data quicker
 	int floorIsRailSwitchAndHeadShiftedBitmask = floorIsRailSwitchAndHeadBitmask << redShift;
@@ -445,9 +690,8 @@ void MapState::buildLevels() {
 		level->logStats();
 
 	//initialize utilities for hints
+	//start state hints are prefetched on a background thread once the game has begun
 	Level::setupHintSearchHelpers(levels);
-	for (Level* level : levels)
-		level->preAllocatePotentialLevelStates();
 }
 LevelTypes::Plane* MapState::buildPlane(
 	int tile, Level* activeLevel, deque<int>& tileChecks, vector<PlaneConnection>& planeConnections)
@@ -561,6 +805,19 @@ void MapState::deleteMap() {
 	delete[] tileBorders;
 	delete[] heights;
 	delete[] railSwitchIds;
+	delete[] tileFallOffsets;
+	delete[] floorChunksDirty;
+	floorChunkQuads.clear();
+	delete[] floorChunkShadingHeights;
+	floorChunkShadingQuads.clear();
+	railIndicesByFloorChunk.clear();
+	renderRailIndices.clear();
+	railRenderPositions.clear();
+	groupRenderRailIndices.clear();
+	switchIndicesByFloorChunk.clear();
+	resetSwitchIndicesByFloorChunk.clear();
+	renderSwitchIndices.clear();
+	renderResetSwitchIndices.clear();
 	delete[] planeIds;
 	delete[] mapZeroes;
 	for (Rail* rail : rails)
@@ -572,7 +829,6 @@ void MapState::deleteMap() {
 	for (ResetSwitch* resetSwitch : resetSwitches)
 		delete resetSwitch;
 	resetSwitches.clear();
-	Level::deleteHelpers();
 	//don't delete planes, they are owned by the Levels
 	planes.clear();
 	for (Level* level : levels)
@@ -613,6 +869,14 @@ int MapState::getScreenTopWorldY(EntityState* camera, int ticksTime) {
 			}
 		}
 	}
+	int MapState::testAllSolutions() {
+		#ifdef TEST_SOLUTIONS
+			return Level::testAllSolutions(levels);
+		#else
+			Logger::debugLogger.logString("ERROR: solution testing is not enabled");
+			return 1;
+		#endif
+	}
 #endif
 float MapState::antennaCenterWorldX() {
 	return (float)(radioTowerLeftXOffset + SpriteRegistry::radioTower->getSpriteWidth() / 2);
@@ -640,30 +904,49 @@ bool MapState::tileHasRailEnd(int x, int y) {
 	return endSegment->x == x && endSegment->y == y;
 }
 MapState::TileFallResult MapState::tileFalls(int x, int y, char initialHeight, int* outFallY, char* outFallHeight) {
-	TileFallResult blockedFallResult = TileFallResult::Blocked;
+	char tileOffset = tileFallOffsets[(y * mapWidth + x) * floorHeightCount + initialHeight / 2];
+	if (tileOffset == tileFallEmptyOffset)
+		return TileFallResult::Empty;
+	else if (tileOffset == tileFallBlockedOffset)
+		return TileFallResult::Blocked;
+
+	//we found a matching floor tile
+	*outFallY = y + tileOffset;
+	if (outFallHeight != nullptr)
+		*outFallHeight = initialHeight - tileOffset * 2;
+	return TileFallResult::Floor;
+}
+char MapState::findTileFallOffset(int x, int y, char initialHeight) {
+	char blockedFallOffset = tileFallBlockedOffset;
 	//start one tile down and look for an eligible floor below our current height
-	for (char tileOffset = 1; true; tileOffset++) {
+	for (int tileOffset = 1; y + tileOffset < mapHeight; tileOffset++) {
 		char fallHeight = getHeight(x, y + tileOffset);
-		char targetHeight = initialHeight - tileOffset * 2;
+		int targetHeight = initialHeight - tileOffset * 2;
 		//an empty tile height is fine...
 		if (fallHeight == emptySpaceHeight) {
 			//...unless we reached the lowest height, in which case there is no longer a possible fall height
 			if (targetHeight <= 0)
-				return TileFallResult::Empty;
-			blockedFallResult = TileFallResult::Empty;
+				return tileFallEmptyOffset;
+			blockedFallOffset = tileFallEmptyOffset;
 			continue;
 		//this is a cliff face or lower floor, keep looking
 		} else if (fallHeight % 2 == 1 || fallHeight < targetHeight)
 			continue;
 		//the tile is higher than us, we can't fall here
 		else if (fallHeight > targetHeight)
-			return blockedFallResult;
+			return blockedFallOffset;
 
 		//we found a matching floor tile
-		*outFallY = y + tileOffset;
-		if (outFallHeight != nullptr)
-			*outFallHeight = fallHeight;
-		return TileFallResult::Floor;
+		return (char)tileOffset;
+	}
+	//we ran off the bottom of the map without finding anything to land on
+	return tileFallEmptyOffset;
+}
+void MapState::buildTileFallOffsets(int x) {
+	for (int y = 0; y < mapHeight; y++) {
+		char* tileFallOffsetsForTile = tileFallOffsets + (y * mapWidth + x) * floorHeightCount;
+		for (int floorHeightIndex = 0; floorHeightIndex < floorHeightCount; floorHeightIndex++)
+			tileFallOffsetsForTile[floorHeightIndex] = findTileFallOffset(x, y, (char)(floorHeightIndex * 2));
 	}
 }
 KickActionType MapState::getSwitchKickActionType(short switchId) {
@@ -706,6 +989,7 @@ char MapState::verticalTilesHeight(int mapX, int lowMapY, int highMapY) {
 void MapState::setIntroAnimationBootTile(bool showBootTile) {
 	//if we're not showing the boot tile, just show a default tile instead of showing the tile from the floor file
 	tiles[introAnimationBootTileY * mapWidth + introAnimationBootTileX] = showBootTile ? tileBoot : tileFloorFirst;
+	invalidateFloorChunk(introAnimationBootTileX, introAnimationBootTileY);
 }
 void MapState::getLevelStartPosition(int levelN, int* outMapX, int* outMapY, char* outZ) {
 	int startTile = levels[levelN - 1]->getStartTile();
@@ -721,10 +1005,14 @@ void MapState::updateWithPreviousMapState(MapState* prev, int ticksTime) {
 	finishedMapCameraTutorial = prev->finishedMapCameraTutorial;
 	shouldPlayRadioTowerAnimation = false;
 	switchesAnimationFadeInStartTicksTime = prev->switchesAnimationFadeInStartTicksTime;
+	switchFlipsEndTicksTime = prev->switchFlipsEndTicksTime;
 	waveformStartTicksTime = prev->waveformStartTicksTime;
 	waveformEndTicksTime = prev->waveformEndTicksTime;
 	hintState.set(prev->hintState.get());
 
+	int ticksTimeDiff = ticksTime - prev->lastUpdateTicksTime;
+	lastUpdateTicksTime = ticksTime;
+	clearActiveRails();
 	if (Editor::isActive) {
 		//since the editor can add switches and rails, make sure we update our list to track them
 		//we won't connect rail states to switch states since we can't kick switches in the editor
@@ -734,44 +1022,121 @@ void MapState::updateWithPreviousMapState(MapState* prev, int ticksTime) {
 			switchStates.push_back(newSwitchState(switches[switchStates.size()]));
 		while (resetSwitchStates.size() < resetSwitches.size())
 			resetSwitchStates.push_back(newResetSwitchState(resetSwitches[resetSwitchStates.size()]));
+		//the editor can also change rails, so update every state instead of tracking changes
+		//this leaves our revision without a previous revision, so any MapState updated across it will copy every state
+		for (int i = 0; i < (int)prev->switchStates.size(); i++)
+			switchStates[i]->updateWithPreviousSwitchState(prev->switchStates[i]);
+		for (int i = 0; i < (int)prev->resetSwitchStates.size(); i++)
+			resetSwitchStates[i]->updateWithPreviousResetSwitchState(prev->resetSwitchStates[i]);
+		for (int i = 0; i < (int)prev->railStates.size(); i++)
+			railStates[i]->updateWithPreviousRailState(prev->railStates[i], ticksTimeDiff);
+	} else {
+		//catch up to the previous MapState, copying everything if we can't tell what changed
+		StateChanges* changes = getStateChanges(revision);
+		changes->previousRevision = prev->revision;
+		if (!copyChangedStates(prev)) {
+			for (int i = 0; i < (int)prev->switchStates.size(); i++)
+				switchStates[i]->updateWithPreviousSwitchState(prev->switchStates[i]);
+			for (int i = 0; i < (int)prev->resetSwitchStates.size(); i++)
+				resetSwitchStates[i]->updateWithPreviousResetSwitchState(prev->resetSwitchStates[i]);
+			for (int i = 0; i < (int)prev->railStates.size(); i++)
+				railStates[i]->copyState(prev->railStates[i]);
+		}
+		//then move any rails that were moving, and keep them active until they stop
+		for (int railIndex : prev->activeRailIndices) {
+			RailState* railState = railStates[railIndex];
+			railState->updateWithPreviousRailState(prev->railStates[railIndex], ticksTimeDiff);
+			changes->railIndices.push_back(railIndex);
+			if (railState->isMoving())
+				activateRail(railIndex);
+		}
+	}
+	statesRevision = revision;
+
+	particles.updateWithPreviousParticleBuffer(&prev->particles, ticksTime);
+}
+int MapState::trackNewRevision() {
+	stateChangesByRevision.push_back(StateChanges(-1));
+	while ((int)stateChangesByRevision.size() > maxTrackedRevisions) {
+		stateChangesByRevision.pop_front();
+		firstTrackedRevision++;
+	}
+	return firstTrackedRevision + (int)stateChangesByRevision.size() - 1;
+}
+MapState::StateChanges* MapState::getStateChanges(int pRevision) {
+	int revisionIndex = pRevision - firstTrackedRevision;
+	return revisionIndex >= 0 && revisionIndex < (int)stateChangesByRevision.size()
+		? &stateChangesByRevision[revisionIndex]
+		: nullptr;
+}
+bool MapState::copyChangedStates(MapState* prev) {
+	//make sure that every revision between ours and the previous MapState's was updated from the one before it
+	if (statesRevision < 0 || statesRevision >= prev->revision || getStateChanges(statesRevision + 1) == nullptr)
+		return false;
+	for (int checkRevision = statesRevision + 1; checkRevision <= prev->revision; checkRevision++) {
+		if (getStateChanges(checkRevision)->previousRevision != checkRevision - 1)
+			return false;
 	}
-	for (int i = 0; i < (int)prev->switchStates.size(); i++)
-		switchStates[i]->updateWithPreviousSwitchState(prev->switchStates[i]);
-	for (int i = 0; i < (int)prev->resetSwitchStates.size(); i++)
-		resetSwitchStates[i]->updateWithPreviousResetSwitchState(prev->resetSwitchStates[i]);
-	for (int i = 0; i < (int)prev->railStates.size(); i++)
-		railStates[i]->updateWithPreviousRailState(prev->railStates[i], ticksTime);
 
-	while (particles.size() < prev->particles.size())
-		particles.push_back(newParticle(0, 0, 1, 1, 1, false));
-	while (particles.size() > prev->particles.size())
-		particles.pop_back();
-	for (int i = (int)particles.size() - 1; i >= 0; i--) {
-		if (!particles[i].get()->updateWithPreviousParticle(prev->particles[i].get(), ticksTime))
-			particles.erase(particles.begin() + i);
+	for (int copyRevision = statesRevision + 1; copyRevision <= prev->revision; copyRevision++) {
+		StateChanges* changes = getStateChanges(copyRevision);
+		for (int railIndex : changes->railIndices)
+			railStates[railIndex]->copyState(prev->railStates[railIndex]);
+		for (int switchIndex : changes->switchIndices)
+			switchStates[switchIndex]->updateWithPreviousSwitchState(prev->switchStates[switchIndex]);
+		for (int resetSwitchIndex : changes->resetSwitchIndices)
+			resetSwitchStates[resetSwitchIndex]->updateWithPreviousResetSwitchState(prev->resetSwitchStates[resetSwitchIndex]);
 	}
+	return true;
 }
-Particle* MapState::queueParticle(
+void MapState::markRailStateChanged(int railIndex) {
+	StateChanges* changes = getStateChanges(revision);
+	if (changes != nullptr)
+		changes->railIndices.push_back(railIndex);
+	activateRail(railIndex);
+}
+void MapState::activateRail(int railIndex) {
+	//the editor can add rails, so make room for any new ones
+	if ((int)railIsActive.size() < (int)railStates.size())
+		railIsActive.resize(railStates.size(), false);
+	if (railIsActive[railIndex])
+		return;
+	railIsActive[railIndex] = true;
+	activeRailIndices.push_back(railIndex);
+}
+void MapState::clearActiveRails() {
+	for (int railIndex : activeRailIndices)
+		railIsActive[railIndex] = false;
+	activeRailIndices.clear();
+}
+void MapState::markSwitchStateChanged(int switchIndex) {
+	StateChanges* changes = getStateChanges(revision);
+	if (changes != nullptr)
+		changes->switchIndices.push_back(switchIndex);
+}
+void MapState::markResetSwitchStateChanged(int resetSwitchIndex) {
+	StateChanges* changes = getStateChanges(revision);
+	if (changes != nullptr)
+		changes->resetSwitchIndices.push_back(resetSwitchIndex);
+}
+EntityAnimation* MapState::queueParticle(
 	float centerX,
 	float centerY,
 	float r,
 	float g,
 	float b,
 	bool isAbovePlayer,
-	vector<ReferenceCounterHolder<EntityAnimationTypes::Component>> components,
+	initializer_list<ReferenceCounterBorrow<EntityAnimationTypes::Component>> components,
 	int ticksTime)
 {
-	Particle* particle = newParticle(centerX, centerY, r, g, b, isAbovePlayer);
-	particle->beginEntityAnimation(&components, ticksTime);
-	particles.push_back(particle);
-	return particle;
+	return particles.addParticle(centerX, centerY, r, g, b, isAbovePlayer, components, ticksTime);
 }
-Particle* MapState::queueParticleWithWaveColor(
+EntityAnimation* MapState::queueParticleWithWaveColor(
 	float centerX,
 	float centerY,
 	char color,
 	bool isAbovePlayer,
-	vector<ReferenceCounterHolder<EntityAnimationTypes::Component>> components,
+	initializer_list<ReferenceCounterBorrow<EntityAnimationTypes::Component>> components,
 	int ticksTime)
 {
 	float r = (color == squareColor || color == sineColor) ? 1.0f : 0.0f;
@@ -794,7 +1159,8 @@ void MapState::queueEndSegmentParticles(Rail* rail, int ticksTime) {
 			ticksTime);
 }
 void MapState::flipSwitch(short switchId, bool moveRailsForward, bool allowRadioTowerAnimation, int ticksTime) {
-	SwitchState* switchState = switchStates[switchId & railSwitchIndexBitmask];
+	short switchIndex = switchId & railSwitchIndexBitmask;
+	SwitchState* switchState = switchStates[switchIndex];
 	Switch* switch0 = switchState->getSwitch();
 	char switchColor = switch0->getColor();
 	//this is a turn-on-other-switches switch, flip it if we haven't done so already
@@ -807,6 +1173,10 @@ void MapState::flipSwitch(short switchId, bool moveRailsForward, bool allowRadio
 	//this is just a regular switch and we've turned on the parent switch, flip it
 	} else if (lastActivatedSwitchColor >= switchColor) {
 		switchState->flip(moveRailsForward, ticksTime);
+		switchFlipsEndTicksTime = MathUtils::max(switchFlipsEndTicksTime, ticksTime + switchFlipDuration);
+		markSwitchStateChanged(switchIndex);
+		for (int railIndex : *switchState->getConnectedRailIndices())
+			markRailStateChanged(railIndex);
 
 		queueParticleWithWaveColor(
 			switch0->getSwitchWavesCenterX(),
@@ -825,11 +1195,14 @@ void MapState::flipSwitch(short switchId, bool moveRailsForward, bool allowRadio
 	}
 }
 void MapState::flipResetSwitch(short resetSwitchId, KickResetSwitchUndoState* kickResetSwitchUndoState, int ticksTime) {
-	ResetSwitchState* resetSwitchState = resetSwitchStates[resetSwitchId & railSwitchIndexBitmask];
+	short resetSwitchIndex = resetSwitchId & railSwitchIndexBitmask;
+	ResetSwitchState* resetSwitchState = resetSwitchStates[resetSwitchIndex];
 	int maxResetRailColor = -1;
 	if (kickResetSwitchUndoState != nullptr) {
 		for (KickResetSwitchUndoState::RailUndoState& railUndoState : *kickResetSwitchUndoState->getRailUndoStates()) {
-			RailState* railState = railStates[railUndoState.railId & railSwitchIndexBitmask];
+			short railIndex = railUndoState.railId & railSwitchIndexBitmask;
+			RailState* railState = railStates[railIndex];
+			markRailStateChanged(railIndex);
 			if (railState->loadState(railUndoState.fromTargetTileOffset, railUndoState.fromMovementDirection, true)) {
 				Rail* rail = railState->getRail();
 				queueEndSegmentParticles(rail, ticksTime);
@@ -838,7 +1211,12 @@ void MapState::flipResetSwitch(short resetSwitchId, KickResetSwitchUndoState* ki
 		}
 	} else {
 		for (short railId : *resetSwitchState->getResetSwitch()->getAffectedRailIds()) {
-			RailState* railState = railStates[railId & railSwitchIndexBitmask];
+			short railIndex = railId & railSwitchIndexBitmask;
+			RailState* railState = railStates[railIndex];
+			//rails that are already reset don't need any work
+			if (railState->isResetState())
+				continue;
+			markRailStateChanged(railIndex);
 			if (railState->reset(true)) {
 				Rail* rail = railState->getRail();
 				queueEndSegmentParticles(rail, ticksTime);
@@ -847,6 +1225,8 @@ void MapState::flipResetSwitch(short resetSwitchId, KickResetSwitchUndoState* ki
 		}
 	}
 	resetSwitchState->flip(ticksTime);
+	switchFlipsEndTicksTime = MathUtils::max(switchFlipsEndTicksTime, ticksTime + switchFlipDuration);
+	markResetSwitchStateChanged(resetSwitchIndex);
 	if (maxResetRailColor >= 0) {
 		queueParticleWithWaveColor(
 			(float)(resetSwitchState->getResetSwitch()->getCenterX() * tileSize + halfTileSize),
@@ -860,19 +1240,41 @@ void MapState::flipResetSwitch(short resetSwitchId, KickResetSwitchUndoState* ki
 		Audio::resetSwitchWavesSounds[maxResetRailColor]->play(0);
 	}
 }
-void MapState::writeCurrentRailStates(short resetSwitchId, KickResetSwitchUndoState* kickResetSwitchUndoState) {
+void MapState::writeCurrentRailStates(
+	short resetSwitchId, KickResetSwitchUndoState* kickResetSwitchUndoState, bool skipResetRails)
+{
 	vector<KickResetSwitchUndoState::RailUndoState>* railUndoStates = kickResetSwitchUndoState->getRailUndoStates();
 	for (short railId : *resetSwitches[resetSwitchId & railSwitchIndexBitmask]->getAffectedRailIds()) {
 		RailState* railState = railStates[railId & railSwitchIndexBitmask];
+		if (skipResetRails && railState->isResetState())
+			continue;
 		railUndoStates->push_back(
 			KickResetSwitchUndoState::RailUndoState(
 				railId, railState->getTargetTileOffset(), railState->getNextMovementDirection()));
 	}
 }
+#ifdef DEBUG
+	void MapState::validateRestoredRailStates(
+		short resetSwitchId, KickResetSwitchUndoState* appliedUndoState, KickResetSwitchUndoState* restoringUndoState)
+	{
+		for (KickResetSwitchUndoState::RailUndoState& railUndoState : *appliedUndoState->getRailUndoStates()) {
+			RailState* railState = railStates[railUndoState.railId & railSwitchIndexBitmask];
+			if (railState->getTargetTileOffset() == railUndoState.fromTargetTileOffset
+					&& railState->getNextMovementDirection() == railUndoState.fromMovementDirection)
+				continue;
+			short railId = railUndoState.railId;
+			auto restoresRail = [railId](KickResetSwitchUndoState::RailUndoState& other) { return other.railId == railId; };
+			if (!VectorUtils::anyMatch(*restoringUndoState->getRailUndoStates(), restoresRail))
+				Logger::debugLogger.logString(
+					"ERROR: reset switch " + to_string(resetSwitchId & railSwitchIndexBitmask) + ": rail "
+						+ to_string(railId & railSwitchIndexBitmask) + " changes but would not be restored");
+		}
+	}
+#endif
 int MapState::startRadioWavesAnimation(int initialTicksDelay, int ticksTime) {
 	static constexpr int interRadioWavesAnimationTicks = 1500;
 	AudioTypes::Music* radioWavesSound = Audio::radioWavesSounds[lastActivatedSwitchColor];
-	Particle* particle = queueParticleWithWaveColor(
+	EntityAnimation* radioWavesEntityAnimation = queueParticleWithWaveColor(
 		antennaCenterWorldX(),
 		antennaCenterWorldY(),
 		lastActivatedSwitchColor,
@@ -887,7 +1289,7 @@ int MapState::startRadioWavesAnimation(int initialTicksDelay, int ticksTime) {
 			entityAnimationSpriteAnimationWithDelay(SpriteRegistry::radioWavesAnimation),
 		},
 		ticksTime);
-	int radioWavesDuration = particle->getAnimationTicksDuration() - initialTicksDelay;
+	int radioWavesDuration = radioWavesEntityAnimation->getTotalTicksDuration() - initialTicksDelay;
 	int waveformFadedInStartTicksTime = ticksTime + initialTicksDelay;
 	waveformStartTicksTime = waveformFadedInStartTicksTime - waveformStartEndBufferTicks;
 	waveformEndTicksTime = waveformFadedInStartTicksTime + radioWavesDuration + waveformStartEndBufferTicks;
@@ -991,9 +1393,9 @@ void MapState::toggleShowConnections() {
 		finishedConnectionsTutorial = true;
 	}
 }
-Hint* MapState::generateHint(float playerX, float playerY) {
+LevelTypes::Plane* MapState::getHintPlane(float playerX, float playerY) {
 	if (Editor::isActive)
-		return &Hint::none;
+		return nullptr;
 	//with noclip or editing the save file, it's possible to be somewhere that isn't a plane accessible from the start, so don't
 	//	try to generate a hint
 	//should never happen with an umodified save file once the game is released
@@ -1001,18 +1403,56 @@ Hint* MapState::generateHint(float playerX, float playerY) {
 	if (planeId == 0) {
 		Logger::debugLogger.logString(
 			"ERROR: no plane found to generate hint at " + to_string(playerX) + "," + to_string(playerY));
-		return &Hint::none;
+		return nullptr;
 	}
-	LevelTypes::Plane* currentPlane = planes[planeId - 1];
+	return planes[planeId - 1];
+}
+Level::GetRailState MapState::getCurrentRailState() {
+	return [this](short railId, Rail* rail, char* outMovementDirection, char* outTileOffset) {
+		RailState* railState = railStates[railId & railSwitchIndexBitmask];
+		*outMovementDirection = railState->getNextMovementDirection();
+		*outTileOffset = railState->getTargetTileOffset();
+	};
+}
+Hint* MapState::generateHint(float playerX, float playerY) {
+	LevelTypes::Plane* currentPlane = getHintPlane(playerX, playerY);
+	if (currentPlane == nullptr)
+		return &Hint::none;
 	return currentPlane->getOwningLevel()->generateHint(
 		currentPlane,
-		[this](short railId, Rail* rail, char* outMovementDirection, char* outTileOffset) {
-			RailState* railState = railStates[railId & railSwitchIndexBitmask];
-			*outMovementDirection = railState->getNextMovementDirection();
-			*outTileOffset = railState->getTargetTileOffset();
-		},
+		getCurrentRailState(),
+		lastActivatedSwitchColor);
+}
+Hint* MapState::getStartStateHint(float playerX, float playerY) {
+	LevelTypes::Plane* currentPlane = getHintPlane(playerX, playerY);
+	if (currentPlane == nullptr)
+		return nullptr;
+	return currentPlane->getOwningLevel()->getStartStateHint(
+		currentPlane,
+		getCurrentRailState(),
 		lastActivatedSwitchColor);
 }
+void MapState::allowHintPrefetch() {
+	hintPrefetchIsRunning = true;
+	Level::allowHintSearch();
+}
+void MapState::cancelHintPrefetch() {
+	hintPrefetchIsRunning = false;
+	Level::cancelHintSearch();
+}
+void MapState::prefetchStartStateHints() {
+	int prefetchStartTicksTime = (int)SDL_GetTicks();
+	int prefetchStartLevelsCount = prefetchedStartStateHintsCount;
+	while (hintPrefetchIsRunning && !allStartStateHintsPrefetched()) {
+		if (!levels[prefetchedStartStateHintsCount]->prefetchStartStateHint())
+			break;
+		prefetchedStartStateHintsCount++;
+	}
+	Logger::debugLogger.logString(
+		"prefetched " + to_string(prefetchedStartStateHintsCount - prefetchStartLevelsCount) + " level start state hints in "
+			+ to_string((int)SDL_GetTicks() - prefetchStartTicksTime) + "ms"
+			+ (allStartStateHintsPrefetched() ? "" : " before being canceled"));
+}
 void MapState::setHint(Hint* hint, int ticksTime) {
 	hintState.set(newHintState(hint, ticksTime));
 }
@@ -1037,100 +1477,82 @@ void MapState::unlockConnectionsTutorial() {
 	if (lastActivatedSwitchColor >= 0)
 		unlockedConnectionsTutorial = true;
 }
+bool MapState::isAnimating(int ticksTime) {
+	return !particles.isEmpty()
+		|| !activeRailIndices.empty()
+		|| shouldPlayRadioTowerAnimation
+		|| ticksTime < switchFlipsEndTicksTime
+		|| ticksTime < switchesAnimationFadeInStartTicksTime + switchesFadeInDuration
+		|| ticksTime < waveformEndTicksTime
+		|| hintState.get()->isAnimating(ticksTime);
+}
 void MapState::renderBelowPlayer(EntityState* camera, float playerWorldGroundY, char playerZ, int ticksTime) {
-	glDisable(GL_BLEND);
+	SpriteSheet::setBlendEnabled(false);
 	//render the map
-	//these values are just right so that every tile rendered is at least partially in the window and no tiles are left out
+	//these values are just right so that every tile rendered is at least partially in the window, or within the culling
+	//	margin around it, and no tiles are left out
 	int screenLeftWorldX = getScreenLeftWorldX(camera, ticksTime);
 	int screenTopWorldY = getScreenTopWorldY(camera, ticksTime);
-	int tileMinX = MathUtils::max(screenLeftWorldX / tileSize, 0);
-	int tileMinY = MathUtils::max(screenTopWorldY / tileSize, 0);
-	int tileMaxX = MathUtils::min((Config::gameScreenWidth + screenLeftWorldX - 1) / tileSize + 1, mapWidth);
-	int tileMaxY = MathUtils::min((Config::gameScreenHeight + screenTopWorldY - 1) / tileSize + 1, mapHeight);
-	char* useTileBorders = Config::showBlockedFallEdges.isOn() ? tileBorders : mapZeroes;
-	for (int y = tileMinY; y < tileMaxY; y++) {
-		for (int x = tileMinX; x < tileMaxX; x++) {
-			//consider any tile at the max height to be filler
-			int mapIndex = y * mapWidth + x;
-			if (heights[mapIndex] == emptySpaceHeight)
-				continue;
-
-			GLint leftX = (GLint)(x * tileSize - screenLeftWorldX);
-			GLint topY = (GLint)(y * tileSize - screenTopWorldY);
-			(SpriteRegistry::tiles->*SpriteSheet::renderSpriteAtScreenPosition)(
-				(int)(tiles[mapIndex]), (int)(useTileBorders[mapIndex]), leftX, topY);
+	int cullLeftWorldX = screenLeftWorldX - renderCullingMargin;
+	int cullTopWorldY = screenTopWorldY - renderCullingMargin;
+	int cullWidth = Config::gameScreenWidth + renderCullingMargin * 2;
+	int cullHeight = Config::gameScreenHeight + renderCullingMargin * 2;
+	int tileMinX = MathUtils::max(cullLeftWorldX / tileSize, 0);
+	int tileMinY = MathUtils::max(cullTopWorldY / tileSize, 0);
+	int tileMaxX = MathUtils::min((cullWidth + cullLeftWorldX - 1) / tileSize + 1, mapWidth);
+	int tileMaxY = MathUtils::min((cullHeight + cullTopWorldY - 1) / tileSize + 1, mapHeight);
+	bool showBlockedFallEdges = Config::showBlockedFallEdges.isOn();
+	char* useTileBorders = showBlockedFallEdges ? tileBorders : mapZeroes;
+	//every chunk shows tile borders, so they all need to be rebuilt if that changes
+	if (showBlockedFallEdges != floorChunksShowBlockedFallEdges) {
+		for (int i = 0; i < (int)floorChunkQuads.size(); i++)
+			floorChunksDirty[i] = true;
+		floorChunksShowBlockedFallEdges = showBlockedFallEdges;
+	}
+	//the camera may be entirely outside of the map
+	int chunkMaxX = tileMaxX > tileMinX ? (tileMaxX - 1) / floorChunkTileSize : -1;
+	int chunkMaxY = tileMaxY > tileMinY ? (tileMaxY - 1) / floorChunkTileSize : -1;
+	for (int chunkY = tileMinY / floorChunkTileSize; chunkY <= chunkMaxY; chunkY++) {
+		for (int chunkX = tileMinX / floorChunkTileSize; chunkX <= chunkMaxX; chunkX++) {
+			if (floorChunksDirty[chunkY * floorChunksWidth + chunkX].exchange(false))
+				buildFloorChunk(chunkX, chunkY, useTileBorders);
+			SpriteRegistry::tiles->renderQuads(
+				floorChunkQuads[chunkY * floorChunksWidth + chunkX], (GLfloat)-screenLeftWorldX, (GLfloat)-screenTopWorldY);
 		}
 	}
-	glEnable(GL_BLEND);
+	SpriteSheet::setBlendEnabled(true);
 
+	//in the editor, darken tiles that don't match the selected height, if one is selected; otherwise, color tiles that are
+	//	above or below the player, based on how far above or below the player they are, if the setting is enabled
+	int shadingMode = Config::heightBasedShading.state;
+	char shadingHeight = playerZ;
 	if (Editor::isActive) {
-		//darken tiles that don't match the selected height in the editor, if one is selected
-		char editorSelectedHeight = Editor::getSelectedHeight();
-		SpriteSheet::setRectangleColor(0.0f, 0.0f, 0.0f, 0.5f);
-		if (editorSelectedHeight != invalidHeight) {
-			for (int y = tileMinY; y < tileMaxY; y++) {
-				for (int x = tileMinX; x < tileMaxX; x++) {
-					//consider any tile at the max height to be filler
-					char mapHeight = heights[y * mapWidth + x];
-					if (mapHeight == emptySpaceHeight || mapHeight == editorSelectedHeight)
-						continue;
-
-					GLint leftX = (GLint)(x * tileSize - screenLeftWorldX);
-					GLint topY = (GLint)(y * tileSize - screenTopWorldY);
-					SpriteSheet::renderPreColoredRectangle(leftX, topY, leftX + (GLint)tileSize, topY + (GLint)tileSize);
-				}
-			}
-		}
-		SpriteSheet::setRectangleColor(1.0f, 1.0f, 1.0f, 1.0f);
-
-		//stop here if we only render tiles
-		if (editorHideNonTiles)
-			return;
-	//color tiles that are above or below the player, based on how far above or below the player they are, if the setting is
-	//	enabled
-	} else if (Config::heightBasedShading.state != Config::heightBasedShadingOffValue) {
-		static constexpr int nearHeightsEnd = 4;
-		//even distribution from 0%-50% across floor height differences 0-7
-		float maxAlpha = 0.5f;
-		float nearHeightsMaxAlpha = maxAlpha * nearHeightsEnd / highestFloorHeight;
-		if (Config::heightBasedShading.state == Config::heightBasedShadingExtraValue) {
-			//distribute 0%-25% across floor height differences 0-n, and 25%-62.5% across floor height differences n-7
-			nearHeightsMaxAlpha = 0.25f;
-			maxAlpha = 0.625f;
+		shadingMode = editorFloorShadingMode;
+		shadingHeight = Editor::getSelectedHeight();
+	} else if (shadingMode == Config::heightBasedShadingOffValue)
+		shadingHeight = invalidHeight;
+	if (shadingHeight != invalidHeight) {
+		if (shadingMode != floorChunksShadingMode) {
+			for (int i = 0; i < (int)floorChunkShadingQuads.size(); i++)
+				floorChunkShadingHeights[i] = invalidHeight;
+			floorChunksShadingMode = shadingMode;
 		}
-		float nearHeightsMultiplier = nearHeightsMaxAlpha / nearHeightsEnd;
-		float farHeightsMultiplier = (maxAlpha - nearHeightsMaxAlpha) / (highestFloorHeight - nearHeightsEnd);
-		for (int y = tileMinY; y < tileMaxY; y++) {
-			for (int x = tileMinX; x < tileMaxX; x++) {
-				//consider any tile at the max height to be filler
-				char mapHeight = heights[y * mapWidth + x];
-				if (mapHeight == emptySpaceHeight || mapHeight == playerZ)
-					continue;
-
-				if (mapHeight > playerZ)
-					SpriteSheet::setRectangleColor(
-						1.0f,
-						1.0f,
-						1.0f,
-						mapHeight - playerZ <= nearHeightsEnd
-							? (mapHeight - playerZ) * nearHeightsMultiplier
-							: (mapHeight - playerZ - nearHeightsEnd) * farHeightsMultiplier + nearHeightsMaxAlpha);
-				else
-					SpriteSheet::setRectangleColor(
-						0.0f,
-						0.0f,
-						0.0f,
-						playerZ - mapHeight <= nearHeightsEnd
-							? (playerZ - mapHeight) * nearHeightsMultiplier
-							: (playerZ - mapHeight - nearHeightsEnd) * farHeightsMultiplier + nearHeightsMaxAlpha);
-				GLint leftX = (GLint)(x * tileSize - screenLeftWorldX);
-				GLint topY = (GLint)(y * tileSize - screenTopWorldY);
-				SpriteSheet::renderPreColoredRectangle(leftX, topY, leftX + (GLint)tileSize, topY + (GLint)tileSize);
+		for (int chunkY = tileMinY / floorChunkTileSize; chunkY <= chunkMaxY; chunkY++) {
+			for (int chunkX = tileMinX / floorChunkTileSize; chunkX <= chunkMaxX; chunkX++) {
+				if (floorChunkShadingHeights[chunkY * floorChunksWidth + chunkX] != shadingHeight)
+					buildFloorChunkShading(chunkX, chunkY, shadingHeight);
+				SpriteSheet::renderRectangleQuads(
+					floorChunkShadingQuads[chunkY * floorChunksWidth + chunkX],
+					(GLfloat)-screenLeftWorldX,
+					(GLfloat)-screenTopWorldY);
 			}
 		}
-		SpriteSheet::setRectangleColor(1.0f, 1.0f, 1.0f, 1.0f);
 	}
 
+	//stop here if we only render tiles
+	if (Editor::isActive && editorHideNonTiles)
+		return;
+
 	//draw the radio tower immediately after drawing and coloring the tiles
 	if (Editor::isActive)
 		(SpriteRegistry::radioTower->*SpriteSheet::setSpriteColor)(1.0f, 1.0f, 1.0f, 2.0f / 3.0f);
@@ -1143,15 +1565,9 @@ void MapState::renderBelowPlayer(EntityState* camera, float playerWorldGroundY,
 	hintState.get()->renderBelowRails(screenLeftWorldX, screenTopWorldY, ticksTime);
 
 	//draw rail shadows, rails (that are below the player), and switches
-	renderRailStates.clear();
-	for (RailState* railState : railStates) {
-		Rail* rail = railState->getRail();
-		if (!rail->canRender(tileMinX, tileMinY, tileMaxX, tileMaxY))
-			continue;
-		rail->renderShadow(screenLeftWorldX, screenTopWorldY);
-		renderRailStates.push_back(railState);
-	}
-	sort(renderRailStates.begin(), renderRailStates.end(), RailState::effectiveHeightsAreAscending);
+	collectRenderRailStates(tileMinX, tileMinY, tileMaxX, tileMaxY, chunkMaxX, chunkMaxY);
+	for (RailState* railState : renderRailStates)
+		railState->getRail()->renderShadow(screenLeftWorldX, screenTopWorldY);
 	for (RailState* railState : renderRailStates) {
 		//guarantee that the rail renders behind the player if it has an equal or lower height than the player
 		//this is mainly relevant for rail ends
@@ -1159,25 +1575,101 @@ void MapState::renderBelowPlayer(EntityState* camera, float playerWorldGroundY,
 			railState->getRail()->getBaseHeight() <= playerZ ? playerWorldGroundY + mapHeight : playerWorldGroundY;
 		railState->renderBelowPlayer(screenLeftWorldX, screenTopWorldY, effectivePlayerWorldGroundY);
 	}
-	for (SwitchState* switchState : switchStates)
-		switchState->render(
+	if (switchIndicesByFloorChunkDirty.exchange(false))
+		buildSwitchIndicesByFloorChunk();
+	int chunkMinX = tileMinX / floorChunkTileSize;
+	int chunkMinY = tileMinY / floorChunkTileSize;
+	collectFloorChunkIndices(
+		switchIndicesByFloorChunk, chunkMinX, chunkMinY, chunkMaxX, chunkMaxY, (int)switchStates.size(), &renderSwitchIndices);
+	for (short switchIndex : renderSwitchIndices)
+		switchStates[switchIndex]->render(
 			screenLeftWorldX,
 			screenTopWorldY,
 			lastActivatedSwitchColor,
 			ticksTime - switchesAnimationFadeInStartTicksTime,
 			ticksTime);
-	for (ResetSwitchState* resetSwitchState : resetSwitchStates)
-		resetSwitchState->render(screenLeftWorldX, screenTopWorldY, ticksTime);
+	collectFloorChunkIndices(
+		resetSwitchIndicesByFloorChunk,
+		chunkMinX,
+		chunkMinY,
+		chunkMaxX,
+		chunkMaxY,
+		(int)resetSwitchStates.size(),
+		&renderResetSwitchIndices);
+	for (short resetSwitchIndex : renderResetSwitchIndices)
+		resetSwitchStates[resetSwitchIndex]->render(screenLeftWorldX, screenTopWorldY, ticksTime);
 
 	//draw particles below the player
-	for (ReferenceCounterHolder<Particle>& particle : particles) {
-		if (!particle.get()->getIsAbovePlayer())
-			particle.get()->render(camera, ticksTime);
-	}
+	particles.render(camera, false, ticksTime);
 
 	//draw hints above rails, if applicable
 	hintState.get()->renderAboveRails(screenLeftWorldX, screenTopWorldY, ticksTime);
 }
+void MapState::collectRenderRailStates(
+	int tileMinX, int tileMinY, int tileMaxX, int tileMaxY, int chunkMaxX, int chunkMaxY)
+{
+	int railStatesCount = (int)railStates.size();
+	if ((int)railRenderPositions.size() < railStatesCount)
+		railRenderPositions.resize(railStatesCount, -1);
+
+	//keep the rails from the last frame that are still on screen, in the order that they were in
+	//they keep their positions from the last frame until they're sorted, which marks them as already being in the list
+	int keptRailsCount = 0;
+	for (short railIndex : renderRailIndices) {
+		if (railIndex >= railStatesCount
+			|| !railStates[railIndex]->getRail()->canRender(tileMinX, tileMinY, tileMaxX, tileMaxY))
+		{
+			railRenderPositions[railIndex] = -1;
+			continue;
+		}
+		renderRailIndices[keptRailsCount] = railIndex;
+		keptRailsCount++;
+	}
+	renderRailIndices.resize(keptRailsCount);
+
+	//add any rails that came on screen, only looking at the rails in the visible floor chunks
+	//the editor can reshape or add rails at any time, so it checks all of them instead
+	if (Editor::isActive) {
+		for (short railIndex = 0; railIndex < railStatesCount; railIndex++)
+			addRenderRailIndex(railIndex, tileMinX, tileMinY, tileMaxX, tileMaxY);
+	} else {
+		for (int chunkY = tileMinY / floorChunkTileSize; chunkY <= chunkMaxY; chunkY++) {
+			for (int chunkX = tileMinX / floorChunkTileSize; chunkX <= chunkMaxX; chunkX++) {
+				for (short railIndex : railIndicesByFloorChunk[chunkY * floorChunksWidth + chunkX])
+					addRenderRailIndex(railIndex, tileMinX, tileMinY, tileMaxX, tileMaxY);
+			}
+		}
+	}
+
+	//the order from the last frame is nearly sorted, so an insertion sort only has to move the rails whose heights changed
+	//	or that just came on screen
+	for (int i = 1; i < (int)renderRailIndices.size(); i++) {
+		short railIndex = renderRailIndices[i];
+		RailState* railState = railStates[railIndex];
+		int insertIndex = i;
+		while (insertIndex > 0
+			&& RailState::effectiveHeightsAreAscending(railState, railStates[renderRailIndices[insertIndex - 1]]))
+		{
+			renderRailIndices[insertIndex] = renderRailIndices[insertIndex - 1];
+			insertIndex--;
+		}
+		renderRailIndices[insertIndex] = railIndex;
+	}
+
+	renderRailStates.clear();
+	for (int i = 0; i < (int)renderRailIndices.size(); i++) {
+		short railIndex = renderRailIndices[i];
+		renderRailStates.push_back(railStates[railIndex]);
+		railRenderPositions[railIndex] = (short)i;
+	}
+}
+void MapState::addRenderRailIndex(short railIndex, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY) {
+	if (railRenderPositions[railIndex] >= 0
+			|| !railStates[railIndex]->getRail()->canRender(tileMinX, tileMinY, tileMaxX, tileMaxY))
+		return;
+	railRenderPositions[railIndex] = (short)renderRailIndices.size();
+	renderRailIndices.push_back(railIndex);
+}
 void MapState::renderAbovePlayer(EntityState* camera, int ticksTime) {
 	if (Editor::isActive && editorHideNonTiles)
 		return;
@@ -1188,7 +1680,7 @@ void MapState::renderAbovePlayer(EntityState* camera, int ticksTime) {
 		railState->renderAbovePlayer(screenLeftWorldX, screenTopWorldY);
 
 	if (showConnectionsEnabled) {
-		glDisable(GL_BLEND);
+		SpriteSheet::setBlendEnabled(false);
 		//show movement directions and groups above the player for all rails
 		for (RailState* railState : renderRailStates) {
 			Rail* rail = railState->getRail();
@@ -1197,20 +1689,18 @@ void MapState::renderAbovePlayer(EntityState* camera, int ticksTime) {
 			railState->renderMovementDirections(screenLeftWorldX, screenTopWorldY);
 			rail->renderGroups(screenLeftWorldX, screenTopWorldY);
 		}
-		for (Switch* switch0 : switches) {
+		for (short switchIndex : renderSwitchIndices) {
+			Switch* switch0 = switches[switchIndex];
 			if (switch0->getGroup() != 0)
 				switch0->renderGroup(screenLeftWorldX, screenTopWorldY);
 		}
-		for (ResetSwitch* resetSwitch : resetSwitches)
-			resetSwitch->renderGroups(screenLeftWorldX, screenTopWorldY, nullptr);
-		glEnable(GL_BLEND);
+		for (short resetSwitchIndex : renderResetSwitchIndices)
+			resetSwitches[resetSwitchIndex]->renderGroups(screenLeftWorldX, screenTopWorldY, nullptr);
+		SpriteSheet::setBlendEnabled(true);
 	}
 
 	//draw particles above the player
-	for (ReferenceCounterHolder<Particle>& particle : particles) {
-		if (particle.get()->getIsAbovePlayer())
-			particle.get()->render(camera, ticksTime);
-	}
+	particles.render(camera, true, ticksTime);
 
 	//draw the waveform graphic if applicable
 	if (ticksTime < waveformEndTicksTime && ticksTime > waveformStartTicksTime) {
@@ -1302,7 +1792,7 @@ bool MapState::renderGroupsForRailsToReset(EntityState* camera, short resetSwitc
 	int screenTopWorldY = getScreenTopWorldY(camera, ticksTime);
 	ResetSwitch* resetSwitch = resetSwitches[resetSwitchId & railSwitchIndexBitmask];
 	bool hasRailsToReset = false;
-	glDisable(GL_BLEND);
+	SpriteSheet::setBlendEnabled(false);
 	for (short railId : *resetSwitch->getAffectedRailIds()) {
 		RailState* railState = railStates[railId & railSwitchIndexBitmask];
 		if (railState->isInDefaultState())
@@ -1316,7 +1806,7 @@ bool MapState::renderGroupsForRailsToReset(EntityState* camera, short resetSwitc
 	}
 	if (hasRailsToReset)
 		resetSwitch->renderGroups(screenLeftWorldX, screenTopWorldY, colorsBeingReset);
-	glEnable(GL_BLEND);
+	SpriteSheet::setBlendEnabled(true);
 	return hasRailsToReset;
 }
 void MapState::renderGroupsForRailsFromSwitch(EntityState* camera, short switchId, int ticksTime) {
@@ -1329,21 +1819,31 @@ void MapState::renderGroupsForRailsFromSwitch(EntityState* camera, short switchI
 		return;
 	int screenLeftWorldX = getScreenLeftWorldX(camera, ticksTime);
 	int screenTopWorldY = getScreenTopWorldY(camera, ticksTime);
-	glDisable(GL_BLEND);
-	for (RailState* railState : renderRailStates) {
-		Rail* rail = railState->getRail();
-		if (rail->getColor() != color)
+	SpriteSheet::setBlendEnabled(false);
+	//only draw the rails in this group that are on screen, in the same effective height order that they're drawn in
+	//groups are small, so an insertion sort by render position is enough
+	groupRenderRailIndices.clear();
+	for (short railIndex : railIndicesByColorAndGroup[color * groupCount + group]) {
+		//the editor may have added rails that this state doesn't have yet
+		if (railIndex >= (short)railStates.size() || railRenderPositions[railIndex] < 0)
 			continue;
-		for (char railGroup : rail->getGroups()) {
-			if (railGroup == group) {
-				railState->renderMovementDirections(screenLeftWorldX, screenTopWorldY);
-				rail->renderGroups(screenLeftWorldX, screenTopWorldY);
-				break;
-			}
+		int insertIndex = (int)groupRenderRailIndices.size();
+		groupRenderRailIndices.push_back(railIndex);
+		while (insertIndex > 0
+			&& railRenderPositions[groupRenderRailIndices[insertIndex - 1]] > railRenderPositions[railIndex])
+		{
+			groupRenderRailIndices[insertIndex] = groupRenderRailIndices[insertIndex - 1];
+			insertIndex--;
 		}
+		groupRenderRailIndices[insertIndex] = railIndex;
+	}
+	for (short railIndex : groupRenderRailIndices) {
+		RailState* railState = railStates[railIndex];
+		railState->renderMovementDirections(screenLeftWorldX, screenTopWorldY);
+		railState->getRail()->renderGroups(screenLeftWorldX, screenTopWorldY);
 	}
 	switch0->renderGroup(screenLeftWorldX, screenTopWorldY);
-	glEnable(GL_BLEND);
+	SpriteSheet::setBlendEnabled(true);
 }
 void MapState::renderGroupsForSwitchesFromRail(EntityState* camera, short railId, int ticksTime) {
 	if (!Config::railKickIndicator.isOn())
@@ -1354,17 +1854,14 @@ void MapState::renderGroupsForSwitchesFromRail(EntityState* camera, short railId
 		return;
 	int screenLeftWorldX = getScreenLeftWorldX(camera, ticksTime);
 	int screenTopWorldY = getScreenTopWorldY(camera, ticksTime);
-	glDisable(GL_BLEND);
+	SpriteSheet::setBlendEnabled(false);
 	for (char group : rail->getGroups()) {
-		for (Switch* switch0 : switches) {
-			if (switch0->getGroup() != group || switch0->getColor() != color)
-				continue;
-			switch0->renderGroup(screenLeftWorldX, screenTopWorldY);
-			break;
-		}
+		short switchIndex = switchIndicesByColorAndGroup[color * groupCount + group];
+		if (switchIndex >= 0)
+			switches[switchIndex]->renderGroup(screenLeftWorldX, screenTopWorldY);
 	}
 	rail->renderGroups(screenLeftWorldX, screenTopWorldY);
-	glEnable(GL_BLEND);
+	SpriteSheet::setBlendEnabled(true);
 }
 bool MapState::renderTutorials() {
 	if (showConnectionsTutorial())
@@ -1495,7 +1992,9 @@ bool MapState::loadState(string& line) {
 		dataString = StringUtils::parseNextInt(dataString, &railY);
 		dataString = StringUtils::parseNextInt(dataString, &tileOffset);
 		StringUtils::parseNextInt(dataString, &movementDirection);
-		getRailState(railX, railY)->loadState(tileOffset, movementDirection, false);
+		short railIndex = getRailSwitchId(railX, railY) & railSwitchIndexBitmask;
+		railStates[railIndex]->loadState(tileOffset, movementDirection, false);
+		markRailStateChanged(railIndex);
 	} else
 		return false;
 	return true;
@@ -1506,8 +2005,19 @@ void MapState::resetMap() {
 	finishedMapCameraTutorial = false;
 	unlockedConnectionsTutorial = false;
 	showConnectionsEnabled = false;
-	for (RailState* railState : railStates)
-		railState->reset(false);
+	//only touch the rails that aren't already reset, so that resetting a mostly-reset map is cheap
+	for (int i = 0; i < (int)railStates.size(); i++) {
+		if (railStates[i]->isResetState())
+			continue;
+		railStates[i]->reset(false);
+		markRailStateChanged(i);
+	}
+}
+void MapState::editorSetHeight(int x, int y, char height) {
+	heights[y * mapWidth + x] = height;
+	invalidateFloorChunk(x, y);
+	//falls only look downward, so only this column can be affected
+	buildTileFallOffsets(x);
 }
 void MapState::editorSetAppropriateDefaultFloorTile(int x, int y, char expectedFloorHeight) {
 	char height = getHeight(x, y);
@@ -1564,11 +2074,7 @@ char MapState::editorCompareAdjacentFloorHeight(int x, int y, char floorHeight)
 	}
 }
 bool MapState::editorHasSwitch(char color, char group) {
-	for (Switch* switch0 : switches) {
-		if (switch0->getColor() == color && switch0->getGroup() == group && !switch0->editorIsDeleted)
-			return true;
-	}
-	return false;
+	return switchIndicesByColorAndGroup[color * groupCount + group] >= 0;
 }
 void MapState::editorSetSwitch(int leftX, int topY, char color, char group) {
 	//a switch occupies a 2x2 square, and must be surrounded by a 1-tile ring of no-swich-or-rail tiles
@@ -1657,6 +2163,7 @@ void MapState::editorSetSwitch(int leftX, int topY, char color, char group) {
 		//rewrite the group in reset switches
 		for (ResetSwitch* resetSwitch : resetSwitches)
 			resetSwitch->editorRewriteGroup(color, oldGroup, group);
+		buildColorAndGroupIndex();
 		//don't write a switch ID, we're done
 		return;
 	//we're deleting a switch, remove this group from any matching rails and reset switches
@@ -1684,6 +2191,8 @@ void MapState::editorSetSwitch(int leftX, int topY, char color, char group) {
 			railSwitchIds[switchIdY * mapWidth + switchIdX] = newSwitchId;
 		}
 	}
+	buildColorAndGroupIndex();
+	switchIndicesByFloorChunkDirty = true;
 }
 void MapState::editorSetRail(int x, int y, char color, char group) {
 	//a rail can't go along the edge of the map
@@ -1694,10 +2203,11 @@ void MapState::editorSetRail(int x, int y, char color, char group) {
 	if (!editorHasSwitch(color, group))
 		return;
 
-	//delete a segment from a rail
+	//delete a segment from a rail, or add or remove a group
 	if (tileHasRail(x, y)) {
 		if (rails[getRailSwitchId(x, y) & railSwitchIndexBitmask]->editorRemoveSegment(x, y, color, group))
 			editorSetRailSwitchId(x, y, 0);
+		buildColorAndGroupIndex();
 		return;
 	//delete a segment from a reset switch
 	} else if (tileHasResetSwitch(x, y)) {
@@ -1705,6 +2215,7 @@ void MapState::editorSetRail(int x, int y, char color, char group) {
 		if (resetSwitches[getRailSwitchId(x, y) & railSwitchIndexBitmask]
 				->editorRemoveSegment(x, y, color, group, &freeX, &freeY))
 			editorSetRailSwitchId(freeX, freeY, 0);
+		switchIndicesByFloorChunkDirty = true;
 		return;
 	}
 
@@ -1738,6 +2249,7 @@ void MapState::editorSetRail(int x, int y, char color, char group) {
 	if (editingResetSwitch != nullptr) {
 		if (editingResetSwitch->editorAddSegment(x, y, color, group))
 			editorSetRailSwitchId(x, y, editingRailSwitchId);
+		switchIndicesByFloorChunkDirty = true;
 	//add to a rail or create a new rail
 	} else {
 		//add to a rail
@@ -1751,6 +2263,7 @@ void MapState::editorSetRail(int x, int y, char color, char group) {
 			editingRail->addGroup(group);
 			rails.push_back(editingRail);
 		}
+		buildColorAndGroupIndex();
 	}
 }
 void MapState::editorSetResetSwitch(int x, int bottomY) {
@@ -1791,6 +2304,7 @@ void MapState::editorSetResetSwitch(int x, int bottomY) {
 	railSwitchIds[(bottomY - 1) * mapWidth + x] = newResetSwitchId;
 	if (newResetSwitchId != 0)
 		resetSwitches.push_back(newResetSwitch(x, bottomY));
+	switchIndicesByFloorChunkDirty = true;
 }
 void MapState::editorAdjustRailMovementMagnitude(int x, int y, char magnitudeAdd) {
 	if (tileHasRail(x, y))
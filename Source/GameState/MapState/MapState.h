@@ -1,16 +1,15 @@
 #ifndef MAP_STATE_H
 #define MAP_STATE_H
-#include "Util/PooledReferenceCounter.h"
+#include "GameState/EntityState.h"
 
 #define newMapState() produceWithoutArgs(MapState)
 
 class DynamicCameraAnchor;
-class EntityState;
+class EntityAnimation;
 class Hint;
 class HintState;
 class KickResetSwitchUndoState;
 class Level;
-class Particle;
 class Rail;
 class RailState;
 class ResetSwitch;
@@ -56,6 +55,18 @@ private:
 		PlaneConnectionSwitch(Switch* pSwitch0, LevelTypes::Plane* pPlane, int pPlaneConnectionSwitchIndex);
 		virtual ~PlaneConnectionSwitch();
 	};
+	//Should only be allocated within an object, on the stack, or as a static object
+	class StateChanges {
+	public:
+		//the revision that this revision was updated from, or -1 if it wasn't updated from another revision
+		int previousRevision;
+		vector<int> railIndices;
+		vector<int> switchIndices;
+		vector<int> resetSwitchIndices;
+
+		StateChanges(int pPreviousRevision);
+		virtual ~StateChanges();
+	};
 
 public:
 	//map state
@@ -66,13 +77,19 @@ public:
 	static constexpr int emptySpaceHeight = heightCount - 1;
 	static constexpr int highestFloorHeight = heightCount - 2;
 	static constexpr int tileSize = 6;
+	static constexpr int floorChunkTileSize = 32;
+	static constexpr int editorFloorShadingMode = -1;
 	static constexpr int halfTileSize = tileSize / 2;
 	static constexpr int switchSize = 12;
 	static constexpr int switchSideInset = 2;
 	static constexpr int switchTopInset = 1;
 	static constexpr int switchBottomInset = 2;
 	static constexpr char invalidHeight = -1;
+	static constexpr int floorHeightCount = highestFloorHeight / 2 + 1;
 	static constexpr char groupCount = 64;
+	//recorded frames get moved by up to this much to follow the camera when they're drawn, so anything within this much
+	//	of the screen edges gets recorded too
+	static constexpr int renderCullingMargin = tileSize * 4;
 	//animations
 	static constexpr int firstLevelTileOffsetX = 40;
 	static constexpr int firstLevelTileOffsetY = 113;
@@ -160,6 +177,11 @@ private:
 	//bits 0-11 indicate the index in the appropriate rail/switch array, bits 13 and 12 indicate a rail (01), a switch (10), or
 	//	a reset switch (11)
 	static short* railSwitchIds;
+	//for every tile and every floor height, the precomputed result of falling from that height at that tile: the number of
+	//	tiles down to the floor that we land on, or one of the below values if there is no floor to land on
+	static char* tileFallOffsets;
+	static constexpr char tileFallEmptyOffset = 0;
+	static constexpr char tileFallBlockedOffset = -1;
 	static short* planeIds;
 	static char* mapZeroes;
 	static vector<Rail*> rails;
@@ -167,10 +189,64 @@ private:
 	static vector<ResetSwitch*> resetSwitches;
 	static vector<LevelTypes::Plane*> planes;
 	static vector<Level*> levels;
+	//indexed by color * groupCount + group, the index of the switch with that color and group, or -1 if there isn't one
+	static short switchIndicesByColorAndGroup[colorCount * groupCount];
+	//indexed by color * groupCount + group, the indices of the rails with that color that include that group
+	static vector<short> railIndicesByColorAndGroup[colorCount * groupCount];
 	static int mapWidth;
 	static int mapHeight;
+	//the floor is drawn in square chunks of tiles, each prebuilt into a list of quads in world coordinates
+	//recorded render commands share these lists until they're drawn on the render thread, so a chunk's list is replaced
+	//	instead of changed when it's rebuilt
+	static vector<shared_ptr<vector<GLfloat>>> floorChunkQuads;
+	static atomic<bool>* floorChunksDirty;
+	static int floorChunksWidth;
+	static bool floorChunksShowBlockedFallEdges;
+	//each floor chunk also has a list of translucent rectangles that shade its tiles relative to a reference height
+	static vector<shared_ptr<vector<GLfloat>>> floorChunkShadingQuads;
+	//the reference height that each chunk's shading was built for, or invalidHeight if it needs to be rebuilt
+	static char* floorChunkShadingHeights;
+	//the kind of shading that the chunks were built for, either a heightBasedShading state or editorFloorShadingMode
+	static int floorChunksShadingMode;
+	//indexed the same way as the floor chunks, the indices of the rails whose render boxes overlap that chunk
+	static vector<vector<short>> railIndicesByFloorChunk;
+	//the indices of the rails that were rendered in the last frame, in render order
+	//only used while recording render commands on the update thread
+	static vector<short> renderRailIndices;
+	//indexed by rail index, the index of the rail in renderRailIndices, or -1 if it isn't being rendered
+	//only used while recording render commands on the update thread
+	static vector<short> railRenderPositions;
+	//the indices of the rails to draw group indicators for, in render order
+	//only used while recording render commands on the update thread
+	static vector<short> groupRenderRailIndices;
+	//indexed the same way as the floor chunks, the indices of the switches and reset switches that render in that chunk
+	static vector<vector<short>> switchIndicesByFloorChunk;
+	static vector<vector<short>> resetSwitchIndicesByFloorChunk;
+	//set when the editor changes where switches or reset switches render, so that their indices get rebuilt
+	static atomic<bool> switchIndicesByFloorChunkDirty;
+	//the indices of the switches and reset switches in the visible floor chunks this frame
+	//only used while recording render commands on the update thread
+	static vector<short> renderSwitchIndices;
+	static vector<short> renderResetSwitchIndices;
 	static bool editorHideNonTiles;
+	//the prefetch runs on its own thread, so these are shared with the update thread
+	static atomic<bool> hintPrefetchIsRunning;
+	static atomic<int> prefetchedStartStateHintsCount;
+	//every produced MapState gets a new revision, and we track which rail, switch, and reset switch states changed in each
+	//	revision, so that updating a MapState only copies the states that changed since its states were last set
+	//only used on the update thread
+	static deque<StateChanges> stateChangesByRevision;
+	static int firstTrackedRevision;
+	static constexpr int maxTrackedRevisions = 64;
 
+	int revision;
+	//the revision that the rail, switch, and reset switch states matched before this MapState got its current revision
+	int statesRevision;
+	int lastUpdateTicksTime;
+	//rails that may be moving, which need to be updated in the next revision
+	vector<int> activeRailIndices;
+	//indexed by rail index, whether the rail is in activeRailIndices, so that marking a rail doesn't need to search the list
+	vector<bool> railIsActive;
 	vector<RailState*> railStates;
 	vector<SwitchState*> switchStates;
 	vector<ResetSwitchState*> resetSwitchStates;
@@ -180,8 +256,10 @@ private:
 	bool finishedConnectionsTutorial;
 	bool finishedMapCameraTutorial;
 	int switchesAnimationFadeInStartTicksTime;
+	//the time at which the last switch or reset switch flip finishes animating
+	int switchFlipsEndTicksTime;
 	bool shouldPlayRadioTowerAnimation;
-	vector<ReferenceCounterHolder<Particle>> particles;
+	ParticleBuffer particles;
 	int waveformStartTicksTime;
 	int waveformEndTicksTime;
 	ReferenceCounterHolder<HintState> hintState;
@@ -216,14 +294,18 @@ public:
 	char getLastActivatedSwitchColor() { return lastActivatedSwitchColor; }
 	bool getShowConnections() { return showConnectionsEnabled; }
 	bool getShouldPlayRadioTowerAnimation() { return shouldPlayRadioTowerAnimation; }
+	HintState* getHintState() { return hintState.get(); }
 private:
 	bool showMapCameraTutorial() { return !finishedMapCameraTutorial && lastActivatedSwitchColor >= 0; }
 	bool showConnectionsTutorial() { return !finishedConnectionsTutorial && unlockedConnectionsTutorial; }
 public:
 	bool shouldFreezePlayerForTutorial() { return showMapCameraTutorial() || showConnectionsTutorial(); }
 	void finishMapCameraTutorial() { finishedMapCameraTutorial = true; }
-	static void editorSetTile(int x, int y, char tile) { tiles[y * mapWidth + x] = tile; }
-	static void editorSetHeight(int x, int y, char height) { heights[y * mapWidth + x] = height; }
+	static void editorSetTile(int x, int y, char tile) {
+		tiles[y * mapWidth + x] = tile;
+		invalidateFloorChunk(x, y);
+	}
+	static void editorSetHeight(int x, int y, char height);
 	static void editorSetRailSwitchId(int x, int y, short railSwitchId) { railSwitchIds[y * mapWidth + x] = railSwitchId; }
 	//initialize and return a MapState
 	static MapState* produce(objCounterParameters());
@@ -243,6 +325,37 @@ private:
 	//read rail colors and groups from the reset switch segments starting from the given tile, if there is a segment there
 	static void addResetSwitchSegments(
 		int* pixels, int redShift, int firstSegmentIndex, int resetSwitchId, ResetSwitch* resetSwitch, char segmentsSection);
+	//look for a floor to fall to from the given tile at the given height, and return the tile offset of that floor, or
+	//	tileFallEmptyOffset or tileFallBlockedOffset if there isn't one
+	static char findTileFallOffset(int x, int y, char initialHeight);
+	//precompute the fall results for every tile and every floor height in the given column
+	static void buildTileFallOffsets(int x);
+	//index the rails and switches by their color and group, so that we can find all the rails and switches for a group
+	//	without searching through all of them
+	static void buildColorAndGroupIndex();
+	//mark the floor chunk containing this tile as needing to be rebuilt before it's next rendered
+	static void invalidateFloorChunk(int x, int y);
+	//rebuild the quads for the tiles in a floor chunk
+	static void buildFloorChunk(int chunkX, int chunkY, char* useTileBorders);
+	//rebuild the shading rectangles for the tiles in a floor chunk, relative to the given height
+	static void buildFloorChunkShading(int chunkX, int chunkY, char referenceHeight);
+	//index the rails by the floor chunks that they could render in
+	static void buildRailIndicesByFloorChunk();
+	//index the switches and reset switches by the floor chunks that they render in
+	static void buildSwitchIndicesByFloorChunk();
+	//add the index to every floor chunk that overlaps the given (open-ended) tile bounds
+	static void addIndexToFloorChunks(
+		vector<vector<short>>& indicesByFloorChunk, short index, int leftTileX, int topTileY, int rightTileX, int bottomTileY);
+	//collect the indices in the visible floor chunks, in ascending order and without duplicates, skipping any that are at
+	//	least indexCount
+	static void collectFloorChunkIndices(
+		vector<vector<short>>& indicesByFloorChunk,
+		int chunkMinX,
+		int chunkMinY,
+		int chunkMaxX,
+		int chunkMaxY,
+		int indexCount,
+		vector<short>* outIndices);
 	//go through the map and figure out which parts of the map belong to which level
 	static void buildLevels();
 	//breadth-first-search to build a plane
@@ -270,6 +383,10 @@ public:
 		//find the reset switch for the given index and write its top center coordinate
 		//does not write map coordinates if it doesn't find any
 		static void getResetSwitchMapTopCenter(short resetSwitchIndex, int* outMapCenterX, int* outMapTopY);
+		//verify every solution in test_solutions/ against the hint search for every level, using as many threads as
+		//	possible, and log the results
+		//returns the number of solutions that failed verification
+		static int testAllSolutions();
 	#endif
 	//get the center x of the radio tower antenna
 	static float antennaCenterWorldX();
@@ -284,6 +401,7 @@ public:
 	//check if there is a floor tile that is lower than the given height and corresponds to the world ground Y of the given tile
 	//	at the given height, and write it if there is one
 	//if there isn't, return why it wasn't (either because there was an empty tile, or because the space was blocked by a hill
+	//the initial height must be a floor height
 	static TileFallResult tileFalls(int x, int y, char initialHeight, int* outFallY, char* outFallHeight);
 	//a switch can only be kicked if it's group 0 or if its color is activated
 	KickActionType getSwitchKickActionType(short switchId);
@@ -299,25 +417,44 @@ public:
 	static void getLevelStartPosition(int levelN, int* outMapX, int* outMapY, char* outZ);
 	//update the rails and switches of the MapState by reading from the previous state
 	void updateWithPreviousMapState(MapState* prev, int ticksTime);
+private:
+	//start tracking changes for a new revision and return it
+	static int trackNewRevision();
+	//get the changes for the given revision, or nullptr if we aren't tracking it anymore
+	static StateChanges* getStateChanges(int pRevision);
+	//copy every state that changed between the revision of our states and the revision of the previous MapState
+	//returns false without copying anything if the revisions in between aren't all tracked in order
+	bool copyChangedStates(MapState* prev);
+	//track that a state changed in this revision, so that MapStates updated from this one will copy it
+	//rails are also marked as active, so that we keep updating them until they stop moving
+	void markRailStateChanged(int railIndex);
+	//add the rail to the active rails if it isn't already there
+	void activateRail(int railIndex);
+	//empty the active rails list
+	void clearActiveRails();
+	void markSwitchStateChanged(int switchIndex);
+	void markResetSwitchStateChanged(int resetSwitchIndex);
+public:
 	//queue a particle
-	//returns the created Particle
-	Particle* queueParticle(
+	//returns the particle's entity animation
+	EntityAnimation* queueParticle(
 		float centerX,
 		float centerY,
 		float r,
 		float g,
 		float b,
 		bool isAbovePlayer,
-		vector<ReferenceCounterHolder<EntityAnimationTypes::Component>> components,
+		initializer_list<ReferenceCounterBorrow<EntityAnimationTypes::Component>> components,
 		int ticksTime);
 private:
 	//queue a particle colored according to the given waveform color
-	Particle* queueParticleWithWaveColor(
+	//returns the particle's entity animation
+	EntityAnimation* queueParticleWithWaveColor(
 		float centerX,
 		float centerY,
 		char color,
 		bool isAbovePlayer,
-		vector<ReferenceCounterHolder<EntityAnimationTypes::Component>> components,
+		initializer_list<ReferenceCounterBorrow<EntityAnimationTypes::Component>> components,
 		int ticksTime);
 	//queue particles for the end segments of this rail, after a delay of one animation frame
 	void queueEndSegmentParticles(Rail* rail, int ticksTime);
@@ -327,7 +464,16 @@ public:
 	//flip a reset switch
 	void flipResetSwitch(short resetSwitchId, KickResetSwitchUndoState* kickResetSwitchUndoState, int ticksTime);
 	//write the states of all rails affected by the given reset switch into the undo state
-	void writeCurrentRailStates(short resetSwitchId, KickResetSwitchUndoState* kickResetSwitchUndoState);
+	//if the rails are about to be reset, rails that are already reset can be skipped since resetting won't change them, but a
+	//	state that will be used to reset the rails again must include every rail
+	void writeCurrentRailStates(
+		short resetSwitchId, KickResetSwitchUndoState* kickResetSwitchUndoState, bool skipResetRails);
+	#ifdef DEBUG
+		//log an error if the restoring undo state doesn't include a rail that applying the applied undo state will change,
+		//	which would mean that undoing and then redoing (or redoing and then undoing) a reset switch kick loses rails
+		void validateRestoredRailStates(
+			short resetSwitchId, KickResetSwitchUndoState* appliedUndoState, KickResetSwitchUndoState* restoringUndoState);
+	#endif
 	//begin a radio waves animation
 	//returns the duration of the animation that takes place after the initial delay
 	int startRadioWavesAnimation(int initialTicksDelay, int ticksTime);
@@ -341,8 +487,27 @@ public:
 	void spawnBootTurnOnWaves(int initialTicksDelay, float bootCenterX, float bootCenterY, char color, int ticksTime);
 	//toggle the state of showing connections, and any other relevant state
 	void toggleShowConnections();
+private:
+	//get the plane at the given player position, or nullptr if there isn't one that we can generate a hint from
+	static LevelTypes::Plane* getHintPlane(float playerX, float playerY);
+	//get a rail state retriever that reads from this MapState's rail states
+	function<void(short railId, Rail* rail, char* outMovementDirection, char* outTileOffset)> getCurrentRailState();
+public:
 	//generate a hint based on the state of the map and the given player position
 	Hint* generateHint(float playerX, float playerY);
+	//if the map is at the start state of the level at the given player position, return the prefetched hint for it if there
+	//	is one
+	//otherwise, returns nullptr
+	Hint* getStartStateHint(float playerX, float playerY);
+	//returns whether every level has its start state hint prefetched
+	static bool allStartStateHintsPrefetched() { return prefetchedStartStateHintsCount >= (int)levels.size(); }
+	//mark that the hint prefetch may run
+	//should be called before starting the thread that calls prefetchStartStateHints()
+	static void allowHintPrefetch();
+	//stop the hint prefetch, including any in-progress hint search
+	static void cancelHintPrefetch();
+	//prefetch start state hints for levels in order, until they're all prefetched or the prefetch is canceled
+	static void prefetchStartStateHints();
 	//set the given hint to be shown
 	void setHint(Hint* hint, int ticksTime);
 	//returns true if this MapState should receive a new hint this update
@@ -353,8 +518,17 @@ public:
 	int getLevelN(float playerX, float playerY);
 	//unlock the show-connections tutorial if applicable
 	void unlockConnectionsTutorial();
+	//returns whether anything drawn for this MapState changes over time at or after the given time
+	bool isAnimating(int ticksTime);
 	//render the map
 	void renderBelowPlayer(EntityState* camera, float playerWorldGroundY, char playerZ, int ticksTime);
+private:
+	//update the list of rails to render this frame from the list rendered in the last frame, and sort them by height
+	//takes the (open-ended) tile bounds of the screen and the (closed) bounds of the visible floor chunks
+	void collectRenderRailStates(int tileMinX, int tileMinY, int tileMaxX, int tileMaxY, int chunkMaxX, int chunkMaxY);
+	//add the rail to the list of rails to render if it's on screen and not already in the list
+	void addRenderRailIndex(short railIndex, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY);
+public:
 	//render anything (rails, groups) that render above the player
 	//assumes renderBelowPlayer() has already been called to set the rails above the player
 	void renderAbovePlayer(EntityState* camera, int ticksTime);
@@ -362,6 +536,7 @@ public:
 	//return whether any groups were drawn
 	bool renderGroupsForRailsToReset(EntityState* camera, short resetSwitchId, int ticksTime);
 	//render the groups for rails that have the group of this switch
+	//assumes renderBelowPlayer() has already been called to find which rails are on screen
 	void renderGroupsForRailsFromSwitch(EntityState* camera, short switchId, int ticksTime);
 	//render the groups for switches that have a group in this rail
 	void renderGroupsForSwitchesFromRail(EntityState* camera, short railId, int ticksTime);
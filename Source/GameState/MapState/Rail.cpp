@@ -462,15 +462,21 @@ rail(pRail)
 , bouncesRemaining(0)
 , nextMovementDirection(pRail->getInitialMovementDirection())
 , distancePerMovement(pRail->getColor() == MapState::squareColor ? pRail->getMaxTileOffset() : pRail->getMovementMagnitude())
-, segmentsAbovePlayer()
-, lastUpdateTicksTime(0) {
+, segmentsAbovePlayer() {
 }
 RailState::~RailState() {
 	//don't delete the rail, it's owned by MapState
 }
-void RailState::updateWithPreviousRailState(RailState* prev, int ticksTime) {
+void RailState::copyState(RailState* other) {
+	tileOffset = other->tileOffset;
+	targetTileOffset = other->targetTileOffset;
+	currentMovementDirection = other->currentMovementDirection;
+	effectiveHeight = other->effectiveHeight;
+	bouncesRemaining = other->bouncesRemaining;
+	nextMovementDirection = other->nextMovementDirection;
+}
+void RailState::updateWithPreviousRailState(RailState* prev, int ticksTimeDiff) {
 	targetTileOffset = prev->targetTileOffset;
-	lastUpdateTicksTime = ticksTime;
 	if (Editor::isActive) {
 		targetTileOffset = rail->getInitialTileOffset();
 		tileOffset = (float)targetTileOffset;
@@ -482,7 +488,7 @@ void RailState::updateWithPreviousRailState(RailState* prev, int ticksTime) {
 	currentMovementDirection = prev->currentMovementDirection;
 	bouncesRemaining = prev->bouncesRemaining;
 	nextMovementDirection = prev->nextMovementDirection;
-	float tileOffsetDiff = distancePerMovement * (ticksTime - prev->lastUpdateTicksTime) / fullMovementDurationTicks;
+	float tileOffsetDiff = distancePerMovement * ticksTimeDiff / fullMovementDurationTicks;
 	//adjust speed/distance depending on the rail
 	switch (rail->getColor()) {
 		case MapState::squareColor:
@@ -493,7 +499,7 @@ void RailState::updateWithPreviousRailState(RailState* prev, int ticksTime) {
 				tileOffsetDiff *= 8.0f;
 			break;
 		case MapState::sineColor:
-			updateSineRailTileOffset(prev, ticksTime);
+			updateSineRailTileOffset(prev, ticksTimeDiff);
 			effectiveHeight = rail->getBaseHeight() - 2 * tileOffset;
 			return;
 		case MapState::triangleColor:
@@ -522,13 +528,12 @@ void RailState::updateWithPreviousRailState(RailState* prev, int ticksTime) {
 		tileOffset = targetTileOffset;
 	effectiveHeight = rail->getBaseHeight() - 2 * tileOffset;
 }
-void RailState::updateSineRailTileOffset(RailState* prev, int ticksTime) {
+void RailState::updateSineRailTileOffset(RailState* prev, int ticksTimeDiff) {
 	//find the current "angle" for the rail
 	float tileOffsetAngle = acosf(1.0f - prev->tileOffset / rail->getMaxTileOffset() * 2.0f);
 	if (currentMovementDirection < 0)
 		tileOffsetAngle = -tileOffsetAngle;
-	float tileOffsetAngleDiff =
-		distancePerMovement * MathUtils::piOver3 * (ticksTime - prev->lastUpdateTicksTime) / fullMovementDurationTicks;
+	float tileOffsetAngleDiff = distancePerMovement * MathUtils::piOver3 * ticksTimeDiff / fullMovementDurationTicks;
 	//find the next "angle" for the rail
 	float nextTileOffsetAngle;
 	if (bouncesRemaining > 0) {
@@ -71,6 +71,10 @@ public:
 	char getMovementMagnitude() { return movementMagnitude; }
 	int getSegmentCount() { return (int)segments.size(); }
 	Segment* getSegment(int i) { return &segments[i]; }
+	int getRenderLeftTileX() { return renderLeftTileX; }
+	int getRenderTopTileY() { return renderTopTileY; }
+	int getRenderRightTileX() { return renderRightTileX; }
+	int getRenderBottomTileY() { return renderBottomTileY; }
 	//get the sprite index based on which direction the center of this end segment extends towards the rest of the rail
 	static int endSegmentSpriteHorizontalIndex(int xExtents, int yExtents);
 	//get the sprite index based on which other segments this segment extends towards
@@ -131,7 +135,6 @@ private:
 	char nextMovementDirection;
 	float distancePerMovement;
 	vector<Rail::Segment*> segmentsAbovePlayer;
-	int lastUpdateTicksTime;
 
 public:
 	RailState(objCounterParametersComma() Rail* pRail);
@@ -144,11 +147,18 @@ public:
 		return targetTileOffset == rail->getInitialTileOffset() && nextMovementDirection == rail->getInitialMovementDirection();
 	}
 	bool canRide() { return tileOffset == 0.0f; }
+	bool isMoving() { return bouncesRemaining != 0 || tileOffset != (float)targetTileOffset; }
+	//whether reset() would leave this rail exactly as it is
+	bool isResetState() {
+		return isInDefaultState() && !isMoving() && currentMovementDirection == nextMovementDirection;
+	}
 	static bool effectiveHeightsAreAscending(RailState* a, RailState* b) { return a->effectiveHeight < b->effectiveHeight; }
+	//copy the state of the given rail state without moving the rail
+	void copyState(RailState* other);
 	//check if we need to start/stop moving
-	void updateWithPreviousRailState(RailState* prev, int ticksTime);
+	void updateWithPreviousRailState(RailState* prev, int ticksTimeDiff);
 	//update the position of a sine wave rail
-	void updateSineRailTileOffset(RailState* prev, int ticksTime);
+	void updateSineRailTileOffset(RailState* prev, int ticksTimeDiff);
 	//the switch connected to this rail was kicked, move this rail accordingly
 	void triggerMovement(bool moveForward);
 	//render the rail behind the player by rendering each segment, and save which segments are above the player
@@ -87,6 +87,20 @@ bool ResetSwitch::hasGroupForColor(char group, char color) {
 	}
 	return false;
 }
+void ResetSwitch::getRenderTileBounds(int* outLeftTileX, int* outTopTileY, int* outRightTileX, int* outBottomTileY) {
+	*outLeftTileX = centerX;
+	*outTopTileY = bottomY - 1;
+	*outRightTileX = centerX + 1;
+	*outBottomTileY = bottomY + 1;
+	for (vector<Segment>* segments : { &leftSegments, &bottomSegments, &rightSegments }) {
+		for (Segment& segment : *segments) {
+			*outLeftTileX = MathUtils::min(*outLeftTileX, segment.x);
+			*outTopTileY = MathUtils::min(*outTopTileY, segment.y);
+			*outRightTileX = MathUtils::max(*outRightTileX, segment.x + 1);
+			*outBottomTileY = MathUtils::max(*outBottomTileY, segment.y + 1);
+		}
+	}
+}
 void ResetSwitch::getHintRenderBounds(int* outLeftWorldX, int* outTopWorldY, int* outRightWorldX, int* outBottomWorldY) {
 	*outLeftWorldX = centerX * MapState::tileSize;
 	*outTopWorldY = (bottomY - 1) * MapState::tileSize;
@@ -48,6 +48,8 @@ private:
 public:
 	//returns whether the group can be found in any of the segments
 	bool hasGroupForColor(char group, char color);
+	//get the (open-ended) tile bounds of the body and all the segments of this reset switch
+	void getRenderTileBounds(int* outLeftTileX, int* outTopTileY, int* outRightTileX, int* outBottomTileY);
 	//get the bounds of the hint to render for this reset switch
 	void getHintRenderBounds(int* outLeftWorldX, int* outTopWorldY, int* outRightWorldX, int* outBottomWorldY);
 	//render the reset switch body and its segments
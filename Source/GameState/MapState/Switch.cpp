@@ -110,13 +110,15 @@ SwitchState::SwitchState(objCounterParametersComma() Switch* pSwitch0)
 : onlyInDebug(ObjCounter(objCounterArguments()) COMMA)
 switch0(pSwitch0)
 , connectedRailStates()
+, connectedRailIndices()
 , flipOnTicksTime(0) {
 }
 SwitchState::~SwitchState() {
 	//don't delete the switch, it's owned by MapState
 }
-void SwitchState::addConnectedRailState(RailState* railState) {
+void SwitchState::addConnectedRailState(RailState* railState, int railIndex) {
 	connectedRailStates.push_back(railState);
+	connectedRailIndices.push_back(railIndex);
 }
 void SwitchState::flip(bool moveRailsForward, int flipOffTicksTime) {
 	for (RailState* railState : connectedRailStates)
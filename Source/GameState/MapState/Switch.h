@@ -48,6 +48,7 @@ class SwitchState onlyInDebug(: public ObjCounter) {
 private:
 	Switch* switch0;
 	vector<RailState*> connectedRailStates;
+	vector<int> connectedRailIndices;
 	int flipOnTicksTime;
 
 public:
@@ -56,8 +57,9 @@ public:
 
 	Switch* getSwitch() { return switch0; }
 	vector<RailState*>* getConnectedRailStates() { return &connectedRailStates; }
-	//add a rail state to be affected by this switch state
-	void addConnectedRailState(RailState* railState);
+	vector<int>* getConnectedRailIndices() { return &connectedRailIndices; }
+	//add a rail state to be affected by this switch state, along with its index in the MapState's rail states
+	void addConnectedRailState(RailState* railState, int railIndex);
 	//activate rails of the same group and color because this switch was kicked
 	void flip(bool moveRailsForward, int flipOffTicksTime);
 	//save the time that this switch should turn back on
@@ -570,6 +570,7 @@ PauseState::PauseOption* PauseState::buildOptionsMenuOption() {
 							newMultiStateOption(&Config::showActivatedSwitchWaves, "show activated switch waves") COMMA
 							newMultiStateOption(&Config::showBlockedFallEdges, "show blocked fall edges") COMMA
 							newMultiStateOption(&Config::solutionBlockedWarning, "\"solution blocked\" warning") COMMA
+							newMultiStateOption(&Config::upscaleFilter, "upscale filter") COMMA
 							newNavigationOption("back", nullptr) COMMA
 						})) COMMA
 				newNavigationOption(
@@ -636,12 +637,13 @@ bool PauseState::isAtHomeMenu() {
 	}
 	return false;
 }
-PauseState* PauseState::getNextPauseState() {
+PauseState* PauseState::getNextPauseState(bool* outHandledEvents) {
 	PauseState* nextPauseState = this;
 	//handle events
 	SDL_Event gameEvent;
 	while (SDL_PollEvent(&gameEvent) != 0) {
 		PauseState* lastPauseState = nextPauseState;
+		*outHandledEvents = true;
 
 		if (gameEvent.type == SDL_QUIT)
 			nextPauseState = nextPauseState->produceEndPauseState((int)EndPauseDecision::Exit);
@@ -335,7 +335,8 @@ public:
 	bool isAtHomeMenu();
 	//if any keys were pressed, return a new updated pause state, otherwise return this non-updated state
 	//if the game was closed, return whatever intermediate state we have specifying to quit the game
-	PauseState* getNextPauseState();
+	//sets outHandledEvents to true if there were any events, even if they didn't change the pause state
+	PauseState* getNextPauseState(bool* outHandledEvents);
 private:
 	//handle the keypress and return the resulting new pause state
 	PauseState* handleKeyPress(SDL_Scancode keyScancode);
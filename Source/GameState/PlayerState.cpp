@@ -30,6 +30,8 @@
 
 thread* PlayerState::hintSearchThread = nullptr;
 Hint* PlayerState::hintSearchStorage = nullptr;
+thread* PlayerState::hintPrefetchThread = nullptr;
+bool PlayerState::hintPrefetchEnabled = false;
 PlayerState::PlayerState(objCounterParameters())
 : EntityState(objCounterArguments())
 , z(0)
@@ -37,7 +39,7 @@ PlayerState::PlayerState(objCounterParameters())
 , yDirection(0)
 , lastXMovedDelta(0)
 , lastYMovedDelta(0)
-, collisionRect(newCollisionRect(boundingBoxLeftOffset, boundingBoxTopOffset, boundingBoxRightOffset, boundingBoxBottomOffset))
+, collisionRect(boundingBoxLeftOffset, boundingBoxTopOffset, boundingBoxRightOffset, boundingBoxBottomOffset)
 , spriteAnimation(nullptr)
 , spriteAnimationStartTicksTime(-1)
 , spriteDirection(SpriteDirection::Down)
@@ -71,7 +73,6 @@ PlayerState::PlayerState(objCounterParameters())
 , shouldEndGame(false) {
 }
 PlayerState::~PlayerState() {
-	delete collisionRect;
 	//only one PlayerState needs to do this, but this is the right place to do it
 	waitForHintThreadToFinish();
 }
@@ -213,6 +214,7 @@ void PlayerState::generateHint(Hint* useHint, int ticksTime) {
 		hint = useHint;
 		//we can definitely clear the shown hint if we have an advancement hint internally
 		mapState.get()->setHint(&Hint::none, 0);
+		resumeHintPrefetch();
 	} else {
 		//if the map is waiting for the hint search to finish before clearing its hint, set it to CheckingSolution for now
 		//otherwise, clear it while we search for a new hint
@@ -222,10 +224,22 @@ void PlayerState::generateHint(Hint* useHint, int ticksTime) {
 		float timeDiff = (float)(ticksTime - lastUpdateTicksTime);
 		float hintX = x.get()->getValue(timeDiff);
 		float hintY = y.get()->getValue(timeDiff) + boundingBoxCenterYOffset;
+		//if we're at the start of a level and we already have its hint, it will get collected on the next update as though
+		//	the search finished right away
+		hintSearchStorage = mapState.get()->getStartStateHint(hintX, hintY);
+		if (hintSearchStorage != nullptr) {
+			resumeHintPrefetch();
+			return;
+		}
+		//the prefetch shouldn't slow down this search
+		pauseHintPrefetch();
 		ReferenceCounterHolder<MapState> mapStateCapture (mapState.get());
+		Level::allowHintSearch();
 		hintSearchThread = new thread([hintX, hintY, mapStateCapture]() {
 			Logger::setupLogQueue("H");
+			Level::setupThreadHintSearchHelpers();
 			hintSearchStorage = mapStateCapture.get()->generateHint(hintX, hintY);
+			Level::deleteHelpers();
 			Logger::markLogQueueUnused();
 		});
 	}
@@ -364,46 +378,53 @@ void PlayerState::updatePositionWithPreviousPlayerState(PlayerState* prev, const
 void PlayerState::setXAndUpdateCollisionRect(DynamicValue* newX) {
 	x.set(newX);
 	float xPosition = x.get()->getValue(0);
-	collisionRect->left = xPosition + boundingBoxLeftOffset;
-	collisionRect->right = xPosition + boundingBoxRightOffset;
+	collisionRect.left = xPosition + boundingBoxLeftOffset;
+	collisionRect.right = xPosition + boundingBoxRightOffset;
 }
 void PlayerState::setYAndUpdateCollisionRect(DynamicValue* newY) {
 	y.set(newY);
 	float yPosition = y.get()->getValue(0);
-	collisionRect->top = yPosition + boundingBoxTopOffset;
-	collisionRect->bottom = yPosition + boundingBoxBottomOffset;
+	collisionRect.top = yPosition + boundingBoxTopOffset;
+	collisionRect.bottom = yPosition + boundingBoxBottomOffset;
 }
 void PlayerState::collideWithEnvironmentWithPreviousPlayerState(PlayerState* prev) {
 	//find the row and column of tiles that we could collide with
-	int lowMapX = (int)collisionRect->left / MapState::tileSize;
-	int highMapX = (int)collisionRect->right / MapState::tileSize;
-	int lowMapY = (int)collisionRect->top / MapState::tileSize;
-	int highMapY = (int)collisionRect->bottom / MapState::tileSize;
+	int lowMapX = (int)collisionRect.left / MapState::tileSize;
+	int highMapX = (int)collisionRect.right / MapState::tileSize;
+	int lowMapY = (int)collisionRect.top / MapState::tileSize;
+	int highMapY = (int)collisionRect.bottom / MapState::tileSize;
 	int collisionMapX = prev->xDirection < 0 ? lowMapX : highMapX;
 	int collisionMapY = prev->yDirection < 0 ? lowMapY : highMapY;
 
-	vector<ReferenceCounterHolder<CollisionRect>> collidedRects;
-	vector<short> seenSwitchIds;
+	//we check at most one row and one column of tiles, and each tile has at most one rect
+	static constexpr int maxCollidedRectsCount =
+		(int)boundingBoxWidth / MapState::tileSize + 2 + (int)boundingBoxHeight / MapState::tileSize + 2;
+	CollisionRect collidedRects[maxCollidedRectsCount];
+	int collidedRectsCount = 0;
+	short seenSwitchIds[maxCollidedRectsCount];
+	int seenSwitchIdsCount = 0;
 	//check for horizontal collisions, including the corner if we're moving diagonally
 	if (prev->xDirection != 0) {
 		for (int currentMapY = lowMapY; currentMapY <= highMapY; currentMapY++)
-			addMapCollisions(collisionMapX, currentMapY, collidedRects, seenSwitchIds);
+			addMapCollisions(
+				collisionMapX, currentMapY, collidedRects, &collidedRectsCount, seenSwitchIds, &seenSwitchIdsCount);
 	}
 	//check for vertical collisions, excluding the corner if we're moving diagonally
 	if (prev->yDirection != 0) {
 		int iterLowMapX = prev->xDirection < 0 ? lowMapX + 1 : lowMapX;
 		int iterHighMapX = prev->xDirection > 0 ? highMapX - 1 : highMapX;
 		for (int currentMapX = iterLowMapX; currentMapX <= iterHighMapX; currentMapX++)
-			addMapCollisions(currentMapX, collisionMapY, collidedRects, seenSwitchIds);
+			addMapCollisions(
+				currentMapX, collisionMapY, collidedRects, &collidedRectsCount, seenSwitchIds, &seenSwitchIdsCount);
 	}
 
 	//now go through all the rects and collide with them in chronological order from when the player collided with them
-	while (!collidedRects.empty()) {
+	while (collidedRectsCount > 0) {
 		int mostCollidedRectIndex = -1;
 		float mostCollidedRectDuration = 0;
-		for (int i = 0; i < (int)collidedRects.size(); i++) {
-			CollisionRect* collidedRect = collidedRects[i].get();
-			if (!collisionRect->intersects(collidedRect))
+		for (int i = 0; i < collidedRectsCount; i++) {
+			CollisionRect* collidedRect = &collidedRects[i];
+			if (!collisionRect.intersects(collidedRect))
 				continue;
 
 			float collisionDuration = netCollisionDuration(collidedRect);
@@ -418,7 +439,7 @@ void PlayerState::collideWithEnvironmentWithPreviousPlayerState(PlayerState* pre
 			break;
 
 		//we got a collision, find out where we collided and move away from there
-		CollisionRect* collidedRect = collidedRects[mostCollidedRectIndex].get();
+		CollisionRect* collidedRect = &collidedRects[mostCollidedRectIndex];
 		//we hit this rect from the side
 		if (xCollisionDuration(collidedRect) < yCollisionDuration(collidedRect)) {
 			renderInterpolatedX = false;
@@ -434,24 +455,31 @@ void PlayerState::collideWithEnvironmentWithPreviousPlayerState(PlayerState* pre
 					? collidedRect->bottom + smallDistance - boundingBoxTopOffset
 					: collidedRect->top - smallDistance - boundingBoxBottomOffset));
 		}
-		collidedRects.erase(collidedRects.begin() + mostCollidedRectIndex);
+		//the order of the remaining rects doesn't matter, replace this one with the last one
+		collidedRectsCount--;
+		collidedRects[mostCollidedRectIndex] = collidedRects[collidedRectsCount];
 	}
 }
 void PlayerState::addMapCollisions(
-	int mapX, int mapY, vector<ReferenceCounterHolder<CollisionRect>>& collidedRects, vector<short> seenSwitchIds)
+	int mapX,
+	int mapY,
+	CollisionRect* collidedRects,
+	int* collidedRectsCount,
+	short* seenSwitchIds,
+	int* seenSwitchIdsCount)
 {
-	if (MapState::getHeight(mapX, mapY) != z)
-		collidedRects.push_back(
-			newCollisionRect(
-				(float)(mapX * MapState::tileSize),
-				(float)(mapY * MapState::tileSize),
-				(float)((mapX + 1) * MapState::tileSize),
-				(float)((mapY + 1) * MapState::tileSize)));
-	else if (MapState::tileHasSwitch(mapX, mapY)) {
+	if (MapState::getHeight(mapX, mapY) != z) {
+		collidedRects[*collidedRectsCount].set(
+			(float)(mapX * MapState::tileSize),
+			(float)(mapY * MapState::tileSize),
+			(float)((mapX + 1) * MapState::tileSize),
+			(float)((mapY + 1) * MapState::tileSize));
+		(*collidedRectsCount)++;
+	} else if (MapState::tileHasSwitch(mapX, mapY)) {
 		//make sure we haven't already seen this switch yet
 		short switchId = MapState::getRailSwitchId(mapX, mapY);
-		for (short seenSwitchId : seenSwitchIds) {
-			if (seenSwitchId == switchId)
+		for (int i = 0; i < *seenSwitchIdsCount; i++) {
+			if (seenSwitchIds[i] == switchId)
 				return;
 		}
 		//get the top-left corner of the switch
@@ -460,33 +488,35 @@ void PlayerState::addMapCollisions(
 		if (MapState::getRailSwitchId(mapX, mapY - 1) == switchId)
 			mapY--;
 		//now add the switch rect and id
-		collidedRects.push_back(
-			newCollisionRect(
-				(float)(mapX * MapState::tileSize + MapState::switchSideInset),
-				(float)(mapY * MapState::tileSize + MapState::switchTopInset),
-				(float)((mapX + 2) * MapState::tileSize - MapState::switchSideInset),
-				(float)((mapY + 2) * MapState::tileSize - MapState::switchBottomInset)));
-		seenSwitchIds.push_back(switchId);
-	} else if (MapState::tileHasResetSwitchBody(mapX, mapY))
-		collidedRects.push_back(
-			newCollisionRect(
-				(float)(mapX * MapState::tileSize),
-				(float)(mapY * MapState::tileSize),
-				(float)((mapX + 1) * MapState::tileSize),
-				(float)((mapY + 1) * MapState::tileSize)));
+		collidedRects[*collidedRectsCount].set(
+			(float)(mapX * MapState::tileSize + MapState::switchSideInset),
+			(float)(mapY * MapState::tileSize + MapState::switchTopInset),
+			(float)((mapX + 2) * MapState::tileSize - MapState::switchSideInset),
+			(float)((mapY + 2) * MapState::tileSize - MapState::switchBottomInset));
+		(*collidedRectsCount)++;
+		seenSwitchIds[*seenSwitchIdsCount] = switchId;
+		(*seenSwitchIdsCount)++;
+	} else if (MapState::tileHasResetSwitchBody(mapX, mapY)) {
+		collidedRects[*collidedRectsCount].set(
+			(float)(mapX * MapState::tileSize),
+			(float)(mapY * MapState::tileSize),
+			(float)((mapX + 1) * MapState::tileSize),
+			(float)((mapY + 1) * MapState::tileSize));
+		(*collidedRectsCount)++;
+	}
 }
 float PlayerState::netCollisionDuration(CollisionRect* other) {
 	return MathUtils::fmin(xCollisionDuration(other), yCollisionDuration(other));
 }
 float PlayerState::xCollisionDuration(CollisionRect* other) {
 	return lastXMovedDelta < 0
-		? (collisionRect->left - other->right) / lastXMovedDelta
-		: (collisionRect->right - other->left) / lastXMovedDelta;
+		? (collisionRect.left - other->right) / lastXMovedDelta
+		: (collisionRect.right - other->left) / lastXMovedDelta;
 }
 float PlayerState::yCollisionDuration(CollisionRect* other) {
 	return lastYMovedDelta < 0
-		? (collisionRect->top - other->bottom) / lastYMovedDelta
-		: (collisionRect->bottom - other->top) / lastYMovedDelta;
+		? (collisionRect.top - other->bottom) / lastYMovedDelta
+		: (collisionRect.bottom - other->top) / lastYMovedDelta;
 }
 void PlayerState::updateSpriteWithPreviousPlayerState(
 	PlayerState* prev, const Uint8* keyboardState, int ticksTime, bool restartSpriteAnimation)
@@ -912,16 +942,54 @@ void PlayerState::tryCollectCompletedHint(PlayerState* other, int ticksTime) {
 		mapState.get()->setHint(&Hint::none, 0);
 	hint = hintSearchStorage;
 	waitForHintThreadToFinish();
+	resumeHintPrefetch();
 }
 void PlayerState::waitForHintThreadToFinish() {
-	if (hintSearchThread == nullptr)
+	//a prefetched hint may have been stored without a thread
+	if (hintSearchThread == nullptr) {
+		hintSearchStorage = nullptr;
 		return;
+	}
 	Level::cancelHintSearch();
 	hintSearchThread->join();
 	delete hintSearchThread;
 	hintSearchThread = nullptr;
 	hintSearchStorage = nullptr;
 }
+void PlayerState::beginHintPrefetch() {
+	hintPrefetchEnabled = true;
+	resumeHintPrefetch();
+}
+void PlayerState::endHintPrefetch() {
+	hintPrefetchEnabled = false;
+	pauseHintPrefetch();
+}
+void PlayerState::resumeHintPrefetch() {
+	if (!hintPrefetchEnabled || hintSearchThread != nullptr)
+		return;
+	//clear out the previous thread if it finished on its own
+	pauseHintPrefetch();
+	if (MapState::allStartStateHintsPrefetched())
+		return;
+	MapState::allowHintPrefetch();
+	hintPrefetchThread = new thread([]() {
+		Logger::setupLogQueue("P");
+		//this is idle-time work, it shouldn't compete with the update or render threads
+		SDL_SetThreadPriority(SDL_THREAD_PRIORITY_LOW);
+		Level::setupThreadHintSearchHelpers();
+		MapState::prefetchStartStateHints();
+		Level::deleteHelpers();
+		Logger::markLogQueueUnused();
+	});
+}
+void PlayerState::pauseHintPrefetch() {
+	if (hintPrefetchThread == nullptr)
+		return;
+	MapState::cancelHintPrefetch();
+	hintPrefetchThread->join();
+	delete hintPrefetchThread;
+	hintPrefetchThread = nullptr;
+}
 void PlayerState::beginKicking(int ticksTime) {
 	if (entityAnimation.get() != nullptr)
 		return;
@@ -1428,8 +1496,8 @@ void PlayerState::kickResetSwitch(short resetSwitchId, int ticksTime) {
 	addKickResetSwitchComponents(resetSwitchId, &kickAnimationComponents, nullptr, &Hint::none);
 	beginEntityAnimation(&kickAnimationComponents, ticksTime);
 	prepForNewUndoState();
-	mapState.get()->writeCurrentRailStates(
-		resetSwitchId, stackNewKickResetSwitchUndoState(undoState, resetSwitchId, spriteDirection, hint));
+	//the kick resets every rail, so rails that are already reset have nothing to undo
+	stackNewKickResetSwitchUndoState(undoState, resetSwitchId, spriteDirection, hint, mapState.get(), true);
 }
 void PlayerState::addKickResetSwitchComponents(
 	short resetSwitchId,
@@ -1467,6 +1535,15 @@ void PlayerState::prepForNewUndoState() {
 	//clear the redo state
 	setUndoState(redoState, nullptr);
 }
+#ifdef DEBUG
+	void PlayerState::logUndoHistoryBytes() {
+		stringstream message;
+		message
+			<< "Undo history: " << (undoState.get() != nullptr ? undoState.get()->historyBytes : 0) << " undo bytes, "
+			<< (redoState.get() != nullptr ? redoState.get()->historyBytes : 0) << " redo bytes";
+		Logger::debugLogger.logString(message.str());
+	}
+#endif
 void PlayerState::clearUndoRedoStates() {
 	setUndoState(undoState, nullptr);
 	setUndoState(redoState, nullptr);
@@ -1586,8 +1663,16 @@ void PlayerState::undoKickResetSwitch(
 	});
 	addKickResetSwitchComponents(resetSwitchId, &kickAnimationComponents, kickResetSwitchUndoState, fromHint);
 	beginEntityAnimation(&kickAnimationComponents, ticksTime);
-	mapState.get()->writeCurrentRailStates(
-		resetSwitchId, stackNewKickResetSwitchUndoState(isUndo ? redoState : undoState, resetSwitchId, direction, hint));
+	//when undoing, the redo state has to reset the rails again, so it needs every rail even though they're all reset right now
+	//when redoing, the rails get reset again, so like a regular kick, rails that are already reset have nothing to undo
+	#ifdef DEBUG
+		KickResetSwitchUndoState* otherKickResetSwitchUndoState = stackNewKickResetSwitchUndoState(
+			isUndo ? redoState : undoState, resetSwitchId, direction, hint, mapState.get(), !isUndo);
+		mapState.get()->validateRestoredRailStates(resetSwitchId, kickResetSwitchUndoState, otherKickResetSwitchUndoState);
+	#else
+		stackNewKickResetSwitchUndoState(
+			isUndo ? redoState : undoState, resetSwitchId, direction, hint, mapState.get(), !isUndo);
+	#endif
 }
 int PlayerState::getLevelN() {
 	return mapState.get()->getLevelN(lastControlledX, lastControlledY + boundingBoxCenterYOffset);
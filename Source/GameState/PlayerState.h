@@ -1,10 +1,10 @@
+#include "GameState/CollisionRect.h"
 #include "GameState/EntityState.h"
 #include "GameState/MapState/MapState.h"
 #include "Util/Config.h"
 
 #define newPlayerState(mapState) produceWithArgs(PlayerState, mapState)
 
-class CollisionRect;
 class Hint;
 class KickAction;
 enum class KickActionType: int;
@@ -50,13 +50,15 @@ private:
 
 	static thread* hintSearchThread;
 	static Hint* hintSearchStorage;
+	static thread* hintPrefetchThread;
+	static bool hintPrefetchEnabled;
 
 	char z;
 	char xDirection;
 	char yDirection;
 	float lastXMovedDelta;
 	float lastYMovedDelta;
-	CollisionRect* collisionRect;
+	CollisionRect collisionRect;
 	SpriteAnimation* spriteAnimation;
 	int spriteAnimationStartTicksTime;
 	SpriteDirection spriteDirection;
@@ -159,8 +161,14 @@ private:
 	//if we did, move the player and don't render interpolated positions
 	void collideWithEnvironmentWithPreviousPlayerState(PlayerState* prev);
 	//check for collisions at the map tile, either because of a different height or because there's a new switch there
+	//adds any collided rect to the given rects, and any new switch to the given switch ids
 	void addMapCollisions(
-		int mapX, int mapY, vector<ReferenceCounterHolder<CollisionRect>>& collidedRects, vector<short> seenSwitchIds);
+		int mapX,
+		int mapY,
+		CollisionRect* collidedRects,
+		int* collidedRectsCount,
+		short* seenSwitchIds,
+		int* seenSwitchIdsCount);
 	//returns the fraction of the update spent within the bounds of the given rect; since a collision only happens once the
 	//	player is within the bounds in both directions, this is the min of the two collision durations
 	float netCollisionDuration(CollisionRect* other);
@@ -205,6 +213,16 @@ private:
 	void tryCollectCompletedHint(PlayerState* other, int ticksTime);
 	//wait for the hint thread to finish, and clear it
 	static void waitForHintThreadToFinish();
+public:
+	//allow level start state hints to be prefetched on a background thread whenever no other hint search is running
+	static void beginHintPrefetch();
+	//stop prefetching level start state hints, and wait for the prefetch thread to finish
+	static void endHintPrefetch();
+private:
+	//start the hint prefetch thread if it's enabled, there's nothing else searching, and there are hints left to prefetch
+	static void resumeHintPrefetch();
+	//cancel the hint prefetch thread, wait for it to finish, and clear it
+	static void pauseHintPrefetch();
 public:
 	//if we don't have a kicking animation, start one
 	//this should be called after the player has been updated
@@ -257,6 +275,10 @@ private:
 	//prepare for adding a new undo state; add a no-op undo state if there isn't one already, and clear the redo state
 	void prepForNewUndoState();
 public:
+	#ifdef DEBUG
+		//log the approximate memory used by the undo and redo stacks
+		void logUndoHistoryBytes();
+	#endif
 	//delete all undo and redo states
 	void clearUndoRedoStates();
 	//undo an action if there is one to undo
@@ -283,6 +305,8 @@ public:
 		int ticksTime);
 	//get the level that the player is currently on
 	int getLevelN();
+	//returns whether this player state is animating or waiting to begin an animation, not counting moving on its own
+	bool isAnimating() { return hasAnimation() || spriteAnimation != nullptr || autoKickStartTicksTime != -1; }
 	//render this player state, which was deemed to be the last state to need rendering
 	void render(EntityState* camera, int ticksTime);
 	//render the kick action for this player state if one is available
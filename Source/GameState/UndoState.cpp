@@ -1,16 +1,19 @@
 #include "UndoState.h"
 #include "GameState/HintState.h"
 #include "GameState/PlayerState.h"
+#include "GameState/MapState/MapState.h"
+#include "Util/Config.h"
+#include "Util/Logger.h"
 
 #define initializeWithNewFromPoolAndPlaceIntoStack(var, className, stack) \
 	initializeWithNewFromPool(var, className) \
-	var->next.set(stack.get()); \
-	stack.set(var);
+	var->placeIntoStack(stack);
 
 //////////////////////////////// UndoState ////////////////////////////////
 UndoState::UndoState(objCounterParameters())
 : PooledReferenceCounter(objCounterArguments())
-, next(nullptr) {
+, next(nullptr)
+, historyBytes(0) {
 }
 UndoState::~UndoState() {}
 void UndoState::prepareReturnToPool() {
@@ -21,6 +24,56 @@ int UndoState::getNextClassTypeIdentifier() {
 	nextClassTypeIdentifier++;
 	return nextClassTypeIdentifier;
 }
+void UndoState::placeIntoStack(ReferenceCounterHolder<UndoState>& stack) {
+	UndoState* stackTop = stack.get();
+	next.set(stackTop);
+	historyBytes = getMemoryBytes() + (stackTop != nullptr ? stackTop->historyBytes : 0);
+	stack.set(this);
+	//trim down to a fraction of the limit, so that we don't need to walk the stack again on every new state
+	if (historyBytes > Config::undoHistoryMaxBytes)
+		trimHistory();
+}
+void UndoState::trimHistory() {
+	static constexpr int trimmedHistoryBytes = Config::undoHistoryMaxBytes / 4 * 3;
+	#ifdef DEBUG
+		int oldHistoryBytes = historyBytes;
+	#endif
+	//find the oldest state that still fits
+	int keptBytes = 0;
+	UndoState* lastKeptState = this;
+	for (UndoState* undoState = this; undoState != nullptr; undoState = undoState->next.get()) {
+		int memoryBytes = undoState->getMemoryBytes();
+		if (keptBytes + memoryBytes > trimmedHistoryBytes)
+			break;
+		keptBytes += memoryBytes;
+		lastKeptState = undoState;
+	}
+	//the states we keep are shared by every stack that contains them, so update their sizes in place
+	int remainingBytes = keptBytes;
+	for (UndoState* undoState = this; undoState != lastKeptState->next.get(); undoState = undoState->next.get()) {
+		undoState->historyBytes = remainingBytes;
+		remainingBytes -= undoState->getMemoryBytes();
+	}
+	//release the discarded states one at a time to avoid a stack overflow
+	ReferenceCounterHolder<UndoState> discardedStates (lastKeptState->next.get());
+	lastKeptState->next.clear();
+	#ifdef DEBUG
+		int discardedStatesCount = 0;
+	#endif
+	while (discardedStates.get() != nullptr) {
+		discardedStates.set(discardedStates.get()->next.get());
+		#ifdef DEBUG
+			discardedStatesCount++;
+		#endif
+	}
+	#ifdef DEBUG
+		stringstream message;
+		message
+			<< "Undo history reached " << oldHistoryBytes << " bytes, discarded the oldest " << discardedStatesCount
+			<< " states to trim it to " << keptBytes << " bytes";
+		Logger::debugLogger.logString(message.str());
+	#endif
+}
 
 //////////////////////////////// NoOpUndoState ////////////////////////////////
 const int NoOpUndoState::classTypeIdentifier = UndoState::getNextClassTypeIdentifier();
@@ -162,13 +215,17 @@ KickResetSwitchUndoState* KickResetSwitchUndoState::produce(
 	ReferenceCounterHolder<UndoState>& stack,
 	short pResetSwitchId,
 	SpriteDirection pDirection,
-	Hint* pFromHint)
+	Hint* pFromHint,
+	MapState* mapState,
+	bool skipResetRails)
 {
-	initializeWithNewFromPoolAndPlaceIntoStack(k, KickResetSwitchUndoState, stack)
+	initializeWithNewFromPool(k, KickResetSwitchUndoState)
 	k->resetSwitchId = pResetSwitchId;
 	k->direction = pDirection;
 	k->railUndoStates.clear();
 	k->fromHint = pFromHint;
+	mapState->writeCurrentRailStates(pResetSwitchId, k, skipResetRails);
+	k->placeIntoStack(stack);
 	return k;
 }
 pooledReferenceCounterDefineRelease(KickResetSwitchUndoState)
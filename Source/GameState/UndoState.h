@@ -7,16 +7,19 @@
 #define stackNewRideRailUndoState(stack, railId, fromHint) produceWithArgs(RideRailUndoState, stack, railId, fromHint)
 #define stackNewKickSwitchUndoState(stack, switchId, direction, fromHint) \
 	produceWithArgs(KickSwitchUndoState, stack, switchId, direction, fromHint)
-#define stackNewKickResetSwitchUndoState(stack, resetSwitchId, direction, fromHint) \
-	produceWithArgs(KickResetSwitchUndoState, stack, resetSwitchId, direction, fromHint)
+#define stackNewKickResetSwitchUndoState(stack, resetSwitchId, direction, fromHint, mapState, skipResetRails) \
+	produceWithArgs(KickResetSwitchUndoState, stack, resetSwitchId, direction, fromHint, mapState, skipResetRails)
 
 class Hint;
+class MapState;
 class PlayerState;
 enum class SpriteDirection: int;
 
 class UndoState: public PooledReferenceCounter {
 public:
 	ReferenceCounterHolder<UndoState> next;
+	//the approximate memory used by this state and every state after it in the stack
+	int historyBytes;
 
 	UndoState(objCounterParameters());
 	virtual ~UndoState();
@@ -26,9 +29,16 @@ protected:
 	virtual void prepareReturnToPool();
 	//get the next class type identifier for a subclass
 	static int getNextClassTypeIdentifier();
+	//place this state on top of the stack, and discard the oldest states in the stack if it uses too much memory
+	void placeIntoStack(ReferenceCounterHolder<UndoState>& stack);
+private:
+	//discard the oldest states after this one until the stack is back under its trimmed memory size
+	void trimHistory();
 public:
 	//get the type identifier for the implementing subclass
 	virtual int getTypeIdentifier() = 0;
+	//get the approximate memory used by this state alone
+	virtual int getMemoryBytes() = 0;
 	//apply the effect of this state as an undo or a redo
 	//returns false if we should process the next UndoState after this one, or true if we're done
 	virtual bool handle(PlayerState* playerState, bool isUndo, int ticksTime) = 0;
@@ -41,6 +51,7 @@ public:
 	virtual ~NoOpUndoState();
 
 	int getTypeIdentifier() { return classTypeIdentifier; }
+	int getMemoryBytes() { return (int)sizeof(NoOpUndoState); }
 	//initialize and return a NoOpUndoState
 	static NoOpUndoState* produce(objCounterParametersComma() ReferenceCounterHolder<UndoState>& stack);
 	//release a reference to this NoOpUndoState and return it to the pool if applicable
@@ -61,6 +72,7 @@ public:
 	virtual ~MoveUndoState();
 
 	int getTypeIdentifier() { return classTypeIdentifier; }
+	int getMemoryBytes() { return (int)sizeof(MoveUndoState); }
 	//initialize and return a MoveUndoState
 	static MoveUndoState* produce(
 		objCounterParametersComma() ReferenceCounterHolder<UndoState>& stack, float pFromX, float pFromY);
@@ -84,6 +96,7 @@ public:
 	virtual ~ClimbFallUndoState();
 
 	int getTypeIdentifier() { return classTypeIdentifier; }
+	int getMemoryBytes() { return (int)sizeof(ClimbFallUndoState); }
 	//initialize and return a ClimbFallUndoState
 	static ClimbFallUndoState* produce(
 		objCounterParametersComma()
@@ -110,6 +123,7 @@ public:
 	virtual ~RideRailUndoState();
 
 	int getTypeIdentifier() { return classTypeIdentifier; }
+	int getMemoryBytes() { return (int)sizeof(RideRailUndoState); }
 	//initialize and return a RideRailUndoState
 	static RideRailUndoState* produce(
 		objCounterParametersComma() ReferenceCounterHolder<UndoState>& stack, short pRailId, Hint* pFromHint);
@@ -132,6 +146,7 @@ public:
 	virtual ~KickSwitchUndoState();
 
 	int getTypeIdentifier() { return classTypeIdentifier; }
+	int getMemoryBytes() { return (int)sizeof(KickSwitchUndoState); }
 	//initialize and return a KickSwitchUndoState
 	static KickSwitchUndoState* produce(
 		objCounterParametersComma()
@@ -170,14 +185,21 @@ public:
 	virtual ~KickResetSwitchUndoState();
 
 	int getTypeIdentifier() { return classTypeIdentifier; }
+	int getMemoryBytes() {
+		return (int)(sizeof(KickResetSwitchUndoState) + railUndoStates.capacity() * sizeof(RailUndoState));
+	}
 	vector<RailUndoState>* getRailUndoStates() { return &railUndoStates; }
-	//initialize and return a KickResetSwitchUndoState
+	//initialize and return a KickResetSwitchUndoState, recording the current states of the rails affected by the reset switch
+	//	before placing it into the stack, so that its memory size includes them
+	//rails that are already reset are only skipped if requested, see MapState::writeCurrentRailStates()
 	static KickResetSwitchUndoState* produce(
 		objCounterParametersComma()
 		ReferenceCounterHolder<UndoState>& stack,
 		short pResetSwitchId,
 		SpriteDirection pDirection,
-		Hint* pFromHint);
+		Hint* pFromHint,
+		MapState* mapState,
+		bool skipResetRails);
 	//release a reference to this KickResetSwitchUndoState and return it to the pool if applicable
 	virtual void release();
 	//kick the switch
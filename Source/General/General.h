@@ -10,15 +10,19 @@
 	#include <SDL2_mixer/SDL_mixer.h>
 #endif
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <fstream>
 #include <functional>
 #include <iomanip>
 #include <math.h>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 #include "MathUtils.h"
 #include "MemoryManagement.h"
@@ -8,6 +8,7 @@
 		ObjCounter* ObjCounter::headObjCounter = nullptr;
 		ObjCounter* ObjCounter::tailObjCounter = nullptr;
 	#endif
+	mutex ObjCounter::objCountersMutex;
 	int ObjCounter::objCount = 0;
 	int ObjCounter::untrackedObjCount = 0;
 	int ObjCounter::nextObjID = 0;
@@ -16,19 +17,17 @@
 		: objType(pObjType)
 		, objFile(pObjFile)
 		, objLine(pObjLine)
-		, objID(nextObjID)
+		, objID(0)
 		, prevObjCounter(nullptr)
 		, nextObjCounter(nullptr)
 	#endif
 	{
+		objCountersMutex.lock();
 		objCount++;
-		nextObjID++;
-
-		#ifdef LOG_OBJ_ADD_OR_REMOVE
-			stringstream logMessage;
-			logMessage << "  Added " << (void*)this << " " << objType << " " << objID << ", obj count: " << objCount;
-			Logger::debugLogger.logString(logMessage.str());
+		#ifdef TRACK_OBJ_IDS
+			objID = nextObjID;
 		#endif
+		nextObjID++;
 		#ifdef TRACK_OBJ_IDS
 			if (tailObjCounter != nullptr)
 				tailObjCounter->nextObjCounter = this;
@@ -37,14 +36,17 @@
 			if (headObjCounter == nullptr)
 				headObjCounter = this;
 		#endif
-	}
-	ObjCounter::~ObjCounter() {
-		objCount--;
+		objCountersMutex.unlock();
+
 		#ifdef LOG_OBJ_ADD_OR_REMOVE
 			stringstream logMessage;
-			logMessage << "Deleted " << (void*)this << " " << objType << " " << objID << ", obj count: " << objCount;
+			logMessage << "  Added " << (void*)this << " " << objType << " " << objID << ", obj count: " << objCount;
 			Logger::debugLogger.logString(logMessage.str());
 		#endif
+	}
+	ObjCounter::~ObjCounter() {
+		objCountersMutex.lock();
+		objCount--;
 		#ifdef TRACK_OBJ_IDS
 			if (nextObjCounter != nullptr)
 				nextObjCounter->prevObjCounter = prevObjCounter;
@@ -55,6 +57,12 @@
 			else if (this == headObjCounter)
 				headObjCounter = nextObjCounter;
 		#endif
+		objCountersMutex.unlock();
+		#ifdef LOG_OBJ_ADD_OR_REMOVE
+			stringstream logMessage;
+			logMessage << "Deleted " << (void*)this << " " << objType << " " << objID << ", obj count: " << objCount;
+			Logger::debugLogger.logString(logMessage.str());
+		#endif
 	}
 	void ObjCounter::start() {
 		untrackedObjCount = nextObjID;
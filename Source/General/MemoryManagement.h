@@ -28,6 +28,8 @@
 #ifdef DEBUG
 	class ObjCounter {
 	private:
+		//objects may be created and deleted on multiple threads at once
+		static std::mutex objCountersMutex;
 		static int objCount;
 		static int untrackedObjCount;
 		static int nextObjID;
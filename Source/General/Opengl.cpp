@@ -20,6 +20,11 @@ declareGlFunctionSource(glFramebufferTexture2D);
 	declareGlFunctionSource(glCheckFramebufferStatus);
 #endif
 
+GLuint Opengl::nativeFrameBufferId = 0;
+GLuint Opengl::nativeRenderBufferId = 0;
+GLuint Opengl::sharpBilinearFrameBufferId = 0;
+GLuint Opengl::sharpBilinearRenderBufferId = 0;
+int Opengl::sharpBilinearScale = 0;
 bool Opengl::initExtensions() {
 	assignAndVerifyGlFunction(glGenFramebuffers);
 	assignAndVerifyGlFunction(glBindFramebuffer);
@@ -41,9 +46,74 @@ void Opengl::orientRenderTarget(bool topDown) {
 	else
 		glOrtho(0, (GLdouble)Config::windowScreenWidth, 0, (GLdouble)Config::windowScreenHeight, -1, 1);
 }
-void Opengl::clearBackground() {
-	glClearColor(Config::backgroundColorRed, Config::backgroundColorGreen, Config::backgroundColorBlue, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT);
+void Opengl::setupNativeFrameBuffers() {
+	glGenFramebuffers(1, &nativeFrameBufferId);
+	glBindFramebuffer(GL_FRAMEBUFFER, nativeFrameBufferId);
+	glGenRenderbuffers(1, &nativeRenderBufferId);
+	glBindRenderbuffer(GL_RENDERBUFFER, nativeRenderBufferId);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGB8, (GLsizei)Config::windowScreenWidth, (GLsizei)Config::windowScreenHeight);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, nativeRenderBufferId);
+	#ifdef DEBUG
+		checkAndLogFrameBufferStatus(GL_FRAMEBUFFER, "nativeFrameBuffer");
+	#endif
+
+	//the sharp-bilinear render buffer storage depends on the window size, so it gets allocated when it's first used
+	glGenFramebuffers(1, &sharpBilinearFrameBufferId);
+	glGenRenderbuffers(1, &sharpBilinearRenderBufferId);
+
+	//return to the default framebuffer
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+void Opengl::bindNativeFrameBuffer() {
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, nativeFrameBufferId);
+	glViewport(0, 0, (GLsizei)Config::windowScreenWidth, (GLsizei)Config::windowScreenHeight);
+}
+void Opengl::presentNativeFrame() {
+	GLint nativeWidth = (GLint)Config::windowScreenWidth;
+	GLint nativeHeight = (GLint)Config::windowScreenHeight;
+	GLint displayWidth = (GLint)Config::windowDisplayWidth;
+	GLint displayHeight = (GLint)Config::windowDisplayHeight;
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, nativeFrameBufferId);
+
+	//scale up by the largest whole number that fits in the window, and only smooth the remaining fraction of a pixel
+	int scale = MathUtils::max(1, MathUtils::min(displayWidth / nativeWidth, displayHeight / nativeHeight));
+	if (Config::upscaleFilter.state == Config::upscaleFilterSharpBilinearValue && scale > 1) {
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sharpBilinearFrameBufferId);
+		if (scale != sharpBilinearScale) {
+			glBindRenderbuffer(GL_RENDERBUFFER, sharpBilinearRenderBufferId);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_RGB8, nativeWidth * scale, nativeHeight * scale);
+			glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, sharpBilinearRenderBufferId);
+			#ifdef DEBUG
+				checkAndLogFrameBufferStatus(GL_DRAW_FRAMEBUFFER, "sharpBilinearFrameBuffer");
+			#endif
+			sharpBilinearScale = scale;
+		}
+		glBlitFramebuffer(
+			//source
+			0, 0, nativeWidth, nativeHeight,
+			//destination
+			0, 0, nativeWidth * scale, nativeHeight * scale,
+			GL_COLOR_BUFFER_BIT,
+			GL_NEAREST);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, sharpBilinearFrameBufferId);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(
+			//source
+			0, 0, nativeWidth * scale, nativeHeight * scale,
+			//destination
+			0, 0, displayWidth, displayHeight,
+			GL_COLOR_BUFFER_BIT,
+			GL_LINEAR);
+	} else {
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(
+			//source
+			0, 0, nativeWidth, nativeHeight,
+			//destination
+			0, 0, displayWidth, displayHeight,
+			GL_COLOR_BUFFER_BIT,
+			GL_NEAREST);
+	}
 }
 #ifdef DEBUG
 	void Opengl::checkAndLogFrameBufferStatus(GLenum target, const char* frameBufferName) {
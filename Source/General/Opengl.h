@@ -37,6 +37,16 @@ declareGlFunction(
 #endif
 
 class Opengl {
+private:
+	//the whole frame is rendered at the game's native resolution into this frame buffer, and then scaled up to the window
+	static GLuint nativeFrameBufferId;
+	static GLuint nativeRenderBufferId;
+	//for sharp-bilinear upscaling, the native frame is first scaled up by a whole number into this frame buffer, and then
+	//	smoothly scaled the rest of the way to the window
+	static GLuint sharpBilinearFrameBufferId;
+	static GLuint sharpBilinearRenderBufferId;
+	static int sharpBilinearScale;
+
 public:
 	//Prevent allocation
 	Opengl() = delete;
@@ -45,8 +55,12 @@ public:
 	static bool initExtensions();
 	//setup the display to render in the right orientation
 	static void orientRenderTarget(bool topDown);
-	//clear the background with a solid color
-	static void clearBackground();
+	//set up the frame buffers used to render at the game's native resolution
+	static void setupNativeFrameBuffers();
+	//direct all rendering to the native-resolution frame buffer
+	static void bindNativeFrameBuffer();
+	//scale the native-resolution frame up to fill the window
+	static void presentNativeFrame();
 	#ifdef DEBUG
 		//check that the given frame buffer is complete
 		static void checkAndLogFrameBufferStatus(GLenum target, const char* frameBufferName);
@@ -2,6 +2,35 @@
 #include "Util/FileUtils.h"
 #include "Util/Logger.h"
 
+//////////////////////////////// RenderCommandList::Command ////////////////////////////////
+RenderCommandList::Command::Command(CommandType pType, GLuint pId, int pValuesIndex, int pValuesCount)
+: type(pType)
+, id(pId)
+, valuesIndex(pValuesIndex)
+, valuesCount(pValuesCount) {
+}
+RenderCommandList::Command::~Command() {}
+
+//////////////////////////////// RenderCommandList ////////////////////////////////
+RenderCommandList::RenderCommandList()
+: commands()
+, values()
+, sharedVertexLists()
+, openGLFunctions() {
+}
+RenderCommandList::~RenderCommandList() {}
+void RenderCommandList::clear() {
+	commands.clear();
+	values.clear();
+	sharedVertexLists.clear();
+	openGLFunctions.clear();
+}
+void RenderCommandList::addCommand(CommandType type, GLuint id, const GLfloat* commandValues, int commandValuesCount) {
+	commands.push_back(Command(type, id, (int)values.size(), commandValuesCount));
+	values.insert(values.end(), commandValues, commandValues + commandValuesCount);
+}
+
+//////////////////////////////// SpriteSheet ////////////////////////////////
 void (SpriteSheet::* SpriteSheet::renderSpriteSheetRegionAtScreenRegion)(
 		int spriteLeftX,
 		int spriteTopY,
@@ -22,6 +51,15 @@ void (* SpriteSheet::setRectangleColor)(GLfloat red, GLfloat green, GLfloat blue
 void (* SpriteSheet::renderPreColoredRectangle)(GLint leftX, GLint topY, GLint rightX, GLint bottomY) =
 	&SpriteSheet::renderPreColoredRectangleOpenGL;
 SDL_Renderer* SpriteSheet::activeRectangleRenderer = nullptr;
+bool SpriteSheet::openGLEnabled = true;
+vector<SpriteSheet*> SpriteSheet::allSpriteSheets;
+thread_local vector<GLfloat> SpriteSheet::batchVertices;
+thread_local GLuint SpriteSheet::batchTextureId = 0;
+thread_local GLfloat SpriteSheet::currentRed = 1.0f;
+thread_local GLfloat SpriteSheet::currentGreen = 1.0f;
+thread_local GLfloat SpriteSheet::currentBlue = 1.0f;
+thread_local GLfloat SpriteSheet::currentAlpha = 1.0f;
+thread_local RenderCommandList* SpriteSheet::recordingCommandList = nullptr;
 SpriteSheet::SpriteSheet(
 	objCounterParametersComma()
 	SDL_Surface* imageSurface,
@@ -39,21 +77,32 @@ textureId(0)
 , spriteTexPixelHeight(1.0f / (float)imageSurface->h)
 , centerAnchorX(0)
 , centerAnchorY(0) {
-	glGenTextures(1, &textureId);
+	if (openGLEnabled) {
+		glGenTextures(1, &textureId);
 
-	glBindTexture(GL_TEXTURE_2D, textureId);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, textureId);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-	#ifdef WIN32
-		static constexpr GLenum texFormat = GL_RGBA;
-	#else
-		static constexpr GLenum texFormat = GL_BGRA;
-	#endif
-	glTexImage2D(
-		GL_TEXTURE_2D, 0, GL_RGBA, imageSurface->w, imageSurface->h, 0, texFormat, GL_UNSIGNED_BYTE, imageSurface->pixels);
+		#ifdef WIN32
+			static constexpr GLenum texFormat = GL_RGBA;
+		#else
+			static constexpr GLenum texFormat = GL_BGRA;
+		#endif
+		glTexImage2D(
+			GL_TEXTURE_2D,
+			0,
+			GL_RGBA,
+			imageSurface->w,
+			imageSurface->h,
+			0,
+			texFormat,
+			GL_UNSIGNED_BYTE,
+			imageSurface->pixels);
+	}
+	allSpriteSheets.push_back(this);
 
 	//the last row and column of pixels shouldn't get drawn as part of the sprite
 	if (hasBottomRightPixelBorder) {
@@ -77,6 +126,7 @@ textureId(0)
 }
 SpriteSheet::~SpriteSheet() {
 	SDL_FreeSurface(renderSurface);
+	allSpriteSheets.erase(find(allSpriteSheets.begin(), allSpriteSheets.end(), this));
 	#ifdef DEBUG
 		//don't delete activeRenderer, it's managed elsewhere; it should be nullptr by now
 		if (activeRenderer != nullptr)
@@ -96,6 +146,147 @@ SpriteSheet* SpriteSheet::produce(
 	return newSpriteSheet(
 		FileUtils::loadImage(imagePath), horizontalSpriteCount, verticalSpriteCount, hasBottomRightPixelBorder);
 }
+void SpriteSheet::beginBatchQuad(GLuint quadTextureId) {
+	if (quadTextureId != batchTextureId) {
+		flushBatch();
+		batchTextureId = quadTextureId;
+	}
+}
+void SpriteSheet::addBatchVertex(GLfloat x, GLfloat y, GLfloat texX, GLfloat texY) {
+	batchVertices.insert(
+		batchVertices.end(), { x, y, texX, texY, currentRed, currentGreen, currentBlue, currentAlpha });
+}
+void SpriteSheet::setCurrentColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+	currentRed = red;
+	currentGreen = green;
+	currentBlue = blue;
+	currentAlpha = alpha;
+	//batched quads carry their own colors, but keep OpenGL in sync for anything drawn outside of the batch
+	if (recordingCommandList == nullptr)
+		glColor4f(red, green, blue, alpha);
+}
+void SpriteSheet::flushBatch() {
+	if (batchVertices.empty())
+		return;
+	if (recordingCommandList != nullptr)
+		recordingCommandList->addCommand(
+			RenderCommandList::CommandType::Quads, batchTextureId, batchVertices.data(), (int)batchVertices.size());
+	else
+		drawVertices(batchTextureId, batchVertices.data(), (int)batchVertices.size() / batchVertexFloatCount);
+	batchVertices.clear();
+}
+void SpriteSheet::drawVertices(GLuint quadsTextureId, GLfloat* vertexData, int vertexCount) {
+	static constexpr GLsizei stride = (GLsizei)(batchVertexFloatCount * sizeof(GLfloat));
+	if (quadsTextureId != 0) {
+		glEnable(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, quadsTextureId);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, stride, vertexData + 2);
+	}
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, stride, vertexData);
+	glColorPointer(4, GL_FLOAT, stride, vertexData + 4);
+	glDrawArrays(GL_QUADS, 0, (GLsizei)vertexCount);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (quadsTextureId != 0) {
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisable(GL_TEXTURE_2D);
+	}
+	//the OpenGL color is undefined after drawing with a color array, so restore it
+	glColor4f(currentRed, currentGreen, currentBlue, currentAlpha);
+}
+void SpriteSheet::setBlendEnabled(bool blendEnabled) {
+	if (activeRectangleRenderer != nullptr) {
+		SDL_SetRenderDrawBlendMode(activeRectangleRenderer, blendEnabled ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+		return;
+	}
+	flushBatch();
+	if (recordingCommandList != nullptr)
+		recordingCommandList->addCommand(RenderCommandList::CommandType::SetBlendEnabled, blendEnabled ? 1 : 0, nullptr, 0);
+	else if (blendEnabled)
+		glEnable(GL_BLEND);
+	else
+		glDisable(GL_BLEND);
+}
+void SpriteSheet::beginRecording(RenderCommandList* commandList) {
+	flushBatch();
+	recordingCommandList = commandList;
+}
+void SpriteSheet::endRecording() {
+	flushBatch();
+	recordingCommandList = nullptr;
+}
+void SpriteSheet::renderCommands(RenderCommandList* commandList, GLfloat cameraOffsetX, GLfloat cameraOffsetY) {
+	flushBatch();
+	int sharedVertexListsIndex = 0;
+	int openGLFunctionsIndex = 0;
+	for (RenderCommandList::Command& command : commandList->commands) {
+		GLfloat* commandValues = commandList->values.data() + command.valuesIndex;
+		switch (command.type) {
+			case RenderCommandList::CommandType::Quads:
+				drawVertices(command.id, commandValues, command.valuesCount / batchVertexFloatCount);
+				break;
+			case RenderCommandList::CommandType::SharedQuads:
+				drawVerticesAtOffset(
+					command.id,
+					*commandList->sharedVertexLists[sharedVertexListsIndex++],
+					commandValues[0],
+					commandValues[1]);
+				break;
+			case RenderCommandList::CommandType::SetBlendEnabled:
+				if (command.id != 0)
+					glEnable(GL_BLEND);
+				else
+					glDisable(GL_BLEND);
+				break;
+			case RenderCommandList::CommandType::RectangleOutline:
+				drawRectangleOutline(
+					commandValues[0],
+					commandValues[1],
+					commandValues[2],
+					commandValues[3],
+					commandValues[4],
+					commandValues[5],
+					commandValues[6],
+					commandValues[7]);
+				break;
+			case RenderCommandList::CommandType::OpenGLFunction:
+				commandList->openGLFunctions[openGLFunctionsIndex++](commandValues[0]);
+				break;
+			case RenderCommandList::CommandType::BeginCameraOffset:
+				glPushMatrix();
+				glTranslatef(cameraOffsetX, cameraOffsetY, 0.0f);
+				break;
+			case RenderCommandList::CommandType::EndCameraOffset:
+				glPopMatrix();
+				break;
+		}
+	}
+}
+void SpriteSheet::beginCameraOffset() {
+	if (recordingCommandList == nullptr)
+		return;
+	flushBatch();
+	recordingCommandList->addCommand(RenderCommandList::CommandType::BeginCameraOffset, 0, nullptr, 0);
+}
+void SpriteSheet::endCameraOffset() {
+	if (recordingCommandList == nullptr)
+		return;
+	flushBatch();
+	recordingCommandList->addCommand(RenderCommandList::CommandType::EndCameraOffset, 0, nullptr, 0);
+}
+void SpriteSheet::callOpenGLFunction(void (*openGLFunction)(float), float argument) {
+	flushBatch();
+	if (recordingCommandList == nullptr) {
+		openGLFunction(argument);
+		return;
+	}
+	GLfloat value = (GLfloat)argument;
+	recordingCommandList->addCommand(RenderCommandList::CommandType::OpenGLFunction, 0, &value, 1);
+	recordingCommandList->openGLFunctions.push_back(openGLFunction);
+}
 void SpriteSheet::renderWithOpenGL() {
 	renderSpriteSheetRegionAtScreenRegion = &renderSpriteSheetRegionAtScreenRegionOpenGL;
 	renderSpriteAtScreenPosition = &renderSpriteAtScreenPositionOpenGL;
@@ -105,6 +296,7 @@ void SpriteSheet::renderWithOpenGL() {
 	activeRectangleRenderer = nullptr;
 }
 void SpriteSheet::renderWithRenderer(SDL_Renderer* rectangleRenderer) {
+	flushBatch();
 	activeRectangleRenderer = rectangleRenderer;
 	renderSpriteSheetRegionAtScreenRegion = &renderSpriteSheetRegionAtScreenRegionRenderer;
 	renderSpriteAtScreenPosition = &renderSpriteAtScreenPositionRenderer;
@@ -125,6 +317,14 @@ void SpriteSheet::unloadRenderTexture(SDL_Renderer* renderer, SDL_Texture* textu
 	activeRenderer = renderer;
 	activeRenderTexture = texture;
 }
+void SpriteSheet::loadAllRenderTextures(SDL_Renderer* renderer) {
+	for (SpriteSheet* spriteSheet : allSpriteSheets)
+		spriteSheet->loadRenderTexture(renderer, nullptr, nullptr);
+}
+void SpriteSheet::unloadAllRenderTextures() {
+	for (SpriteSheet* spriteSheet : allSpriteSheets)
+		spriteSheet->unloadRenderTexture(nullptr, nullptr);
+}
 void SpriteSheet::withRenderTexture(SDL_Renderer* renderer, function<void()> renderWithTexture) {
 	SDL_Renderer* oldRenderer;
 	SDL_Texture* oldTexture;
@@ -133,7 +333,7 @@ void SpriteSheet::withRenderTexture(SDL_Renderer* renderer, function<void()> ren
 	unloadRenderTexture(oldRenderer, oldTexture);
 }
 void SpriteSheet::setSpriteColorOpenGL(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
-	glColor4f(red, green, blue, alpha);
+	setCurrentColor(red, green, blue, alpha);
 }
 void SpriteSheet::setSpriteColorRenderer(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 	SDL_SetTextureColorMod(activeRenderTexture, (Uint8)(red * 255), (Uint8)(green * 255), (Uint8)(blue * 255));
@@ -153,19 +353,11 @@ void SpriteSheet::renderSpriteSheetRegionAtScreenRegionOpenGL(
 	GLfloat texTopY = (GLfloat)(spriteTopY * spriteTexPixelHeight);
 	GLfloat texRightX = (GLfloat)(spriteRightX * spriteTexPixelWidth);
 	GLfloat texBottomY = (GLfloat)(spriteBottomY * spriteTexPixelHeight);
-	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, textureId);
-	glBegin(GL_QUADS);
-	glTexCoord2f(texLeftX, texTopY);
-	glVertex2i(drawLeftX, drawTopY);
-	glTexCoord2f(texRightX, texTopY);
-	glVertex2i(drawRightX, drawTopY);
-	glTexCoord2f(texRightX, texBottomY);
-	glVertex2i(drawRightX, drawBottomY);
-	glTexCoord2f(texLeftX, texBottomY);
-	glVertex2i(drawLeftX, drawBottomY);
-	glEnd();
-	glDisable(GL_TEXTURE_2D);
+	beginBatchQuad(textureId);
+	addBatchVertex((GLfloat)drawLeftX, (GLfloat)drawTopY, texLeftX, texTopY);
+	addBatchVertex((GLfloat)drawRightX, (GLfloat)drawTopY, texRightX, texTopY);
+	addBatchVertex((GLfloat)drawRightX, (GLfloat)drawBottomY, texRightX, texBottomY);
+	addBatchVertex((GLfloat)drawLeftX, (GLfloat)drawBottomY, texLeftX, texBottomY);
 }
 void SpriteSheet::renderSpriteSheetRegionAtScreenRegionRenderer(
 	int spriteLeftX,
@@ -203,6 +395,72 @@ void SpriteSheet::renderSpriteAtScreenPositionRenderer(
 	SDL_Rect destination { (int)drawLeftX, (int)drawTopY, spriteWidth, spriteHeight };
 	SDL_RenderCopy(activeRenderer, activeRenderTexture, &source, &destination);
 }
+void SpriteSheet::addSpriteQuad(
+	vector<GLfloat>* vertices, int spriteHorizontalIndex, int spriteVerticalIndex, GLfloat drawLeftX, GLfloat drawTopY)
+{
+	GLfloat texLeftX = (GLfloat)(spriteHorizontalIndex * spriteWidth * spriteTexPixelWidth);
+	GLfloat texTopY = (GLfloat)(spriteVerticalIndex * spriteHeight * spriteTexPixelHeight);
+	GLfloat texRightX = (GLfloat)((spriteHorizontalIndex + 1) * spriteWidth * spriteTexPixelWidth);
+	GLfloat texBottomY = (GLfloat)((spriteVerticalIndex + 1) * spriteHeight * spriteTexPixelHeight);
+	GLfloat drawRightX = drawLeftX + (GLfloat)spriteWidth;
+	GLfloat drawBottomY = drawTopY + (GLfloat)spriteHeight;
+	vertices->insert(
+		vertices->end(),
+		{
+			drawLeftX, drawTopY, texLeftX, texTopY, 1.0f, 1.0f, 1.0f, 1.0f,
+			drawRightX, drawTopY, texRightX, texTopY, 1.0f, 1.0f, 1.0f, 1.0f,
+			drawRightX, drawBottomY, texRightX, texBottomY, 1.0f, 1.0f, 1.0f, 1.0f,
+			drawLeftX, drawBottomY, texLeftX, texBottomY, 1.0f, 1.0f, 1.0f, 1.0f,
+		});
+}
+void SpriteSheet::renderQuads(const shared_ptr<vector<GLfloat>>& vertices, GLfloat offsetX, GLfloat offsetY) {
+	if (activeRectangleRenderer == nullptr) {
+		renderSharedVertices(textureId, vertices, offsetX, offsetY);
+		return;
+	}
+	//the renderer copies one quad at a time, using the texture coordinates and positions of its top-left and bottom-right
+	//	vertices
+	for (int i = 0; i < (int)vertices->size(); i += batchVertexFloatCount * 4) {
+		GLfloat* topLeft = vertices->data() + i;
+		GLfloat* bottomRight = topLeft + batchVertexFloatCount * 2;
+		int spriteLeftX = (int)(topLeft[2] * renderSurface->w + 0.5f);
+		int spriteTopY = (int)(topLeft[3] * renderSurface->h + 0.5f);
+		int spriteRightX = (int)(bottomRight[2] * renderSurface->w + 0.5f);
+		int spriteBottomY = (int)(bottomRight[3] * renderSurface->h + 0.5f);
+		setSpriteColorRenderer(topLeft[4], topLeft[5], topLeft[6], topLeft[7]);
+		renderSpriteSheetRegionAtScreenRegionRenderer(
+			spriteLeftX,
+			spriteTopY,
+			spriteRightX,
+			spriteBottomY,
+			(GLint)(topLeft[0] + offsetX),
+			(GLint)(topLeft[1] + offsetY),
+			(GLint)(bottomRight[0] + offsetX),
+			(GLint)(bottomRight[1] + offsetY));
+	}
+	setSpriteColorRenderer(1.0f, 1.0f, 1.0f, 1.0f);
+}
+void SpriteSheet::renderSharedVertices(
+	GLuint quadsTextureId, const shared_ptr<vector<GLfloat>>& vertices, GLfloat offsetX, GLfloat offsetY)
+{
+	if (vertices->empty())
+		return;
+	flushBatch();
+	if (recordingCommandList == nullptr) {
+		drawVerticesAtOffset(quadsTextureId, *vertices, offsetX, offsetY);
+		return;
+	}
+	//share the list instead of copying it, its owner replaces it instead of changing it
+	GLfloat offset[] { offsetX, offsetY };
+	recordingCommandList->addCommand(RenderCommandList::CommandType::SharedQuads, quadsTextureId, offset, 2);
+	recordingCommandList->sharedVertexLists.push_back(vertices);
+}
+void SpriteSheet::drawVerticesAtOffset(GLuint quadsTextureId, vector<GLfloat>& vertices, GLfloat offsetX, GLfloat offsetY) {
+	glPushMatrix();
+	glTranslatef(offsetX, offsetY, 0.0f);
+	drawVertices(quadsTextureId, vertices.data(), (int)vertices.size() / batchVertexFloatCount);
+	glPopMatrix();
+}
 void SpriteSheet::renderSpriteCenteredAtScreenPosition(
 	int spriteHorizontalIndex, int spriteVerticalIndex, float drawCenterX, float drawCenterY)
 {
@@ -210,7 +468,7 @@ void SpriteSheet::renderSpriteCenteredAtScreenPosition(
 		spriteHorizontalIndex, spriteVerticalIndex, (GLint)(drawCenterX - centerAnchorX), (GLint)(drawCenterY - centerAnchorY));
 }
 void SpriteSheet::setRectangleColorOpenGL(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
-	glColor4f(red, green, blue, alpha);
+	setCurrentColor(red, green, blue, alpha);
 }
 void SpriteSheet::setRectangleColorRenderer(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 	SDL_SetRenderDrawColor(
@@ -224,33 +482,88 @@ void SpriteSheet::renderFilledRectangle(
 	setRectangleColor(1.0f, 1.0f, 1.0f, 1.0f);
 }
 void SpriteSheet::renderPreColoredRectangleOpenGL(GLint leftX, GLint topY, GLint rightX, GLint bottomY) {
-	glBegin(GL_QUADS);
-	glVertex2i(leftX, topY);
-	glVertex2i(rightX, topY);
-	glVertex2i(rightX, bottomY);
-	glVertex2i(leftX, bottomY);
-	glEnd();
+	beginBatchQuad(0);
+	addBatchVertex((GLfloat)leftX, (GLfloat)topY, 0.0f, 0.0f);
+	addBatchVertex((GLfloat)rightX, (GLfloat)topY, 0.0f, 0.0f);
+	addBatchVertex((GLfloat)rightX, (GLfloat)bottomY, 0.0f, 0.0f);
+	addBatchVertex((GLfloat)leftX, (GLfloat)bottomY, 0.0f, 0.0f);
+}
+void SpriteSheet::addRectangleQuad(
+	vector<GLfloat>* vertices,
+	GLfloat red,
+	GLfloat green,
+	GLfloat blue,
+	GLfloat alpha,
+	GLfloat leftX,
+	GLfloat topY,
+	GLfloat rightX,
+	GLfloat bottomY)
+{
+	vertices->insert(
+		vertices->end(),
+		{
+			leftX, topY, 0.0f, 0.0f, red, green, blue, alpha,
+			rightX, topY, 0.0f, 0.0f, red, green, blue, alpha,
+			rightX, bottomY, 0.0f, 0.0f, red, green, blue, alpha,
+			leftX, bottomY, 0.0f, 0.0f, red, green, blue, alpha,
+		});
+}
+void SpriteSheet::renderRectangleQuads(const shared_ptr<vector<GLfloat>>& vertices, GLfloat offsetX, GLfloat offsetY) {
+	if (activeRectangleRenderer == nullptr) {
+		renderSharedVertices(0, vertices, offsetX, offsetY);
+		return;
+	}
+	//the renderer fills one rectangle at a time, using the color and position of its top-left and bottom-right vertices
+	for (int i = 0; i < (int)vertices->size(); i += batchVertexFloatCount * 4) {
+		GLfloat* topLeft = vertices->data() + i;
+		GLfloat* bottomRight = topLeft + batchVertexFloatCount * 2;
+		setRectangleColorRenderer(topLeft[4], topLeft[5], topLeft[6], topLeft[7]);
+		renderPreColoredRectangleRenderer(
+			(GLint)(topLeft[0] + offsetX),
+			(GLint)(topLeft[1] + offsetY),
+			(GLint)(bottomRight[0] + offsetX),
+			(GLint)(bottomRight[1] + offsetY));
+	}
+	setRectangleColorRenderer(1.0f, 1.0f, 1.0f, 1.0f);
 }
 void SpriteSheet::renderPreColoredRectangleRenderer(GLint leftX, GLint topY, GLint rightX, GLint bottomY) {
 	SDL_Rect rect { (int)leftX, (int)topY, (int)(rightX - leftX), (int)(bottomY - topY) };
 	SDL_RenderFillRect(activeRectangleRenderer, &rect);
 }
-//TODO: this doesn't draw it pixellated, do something different so that its pixel grid matches the game screen pixel grid
 void SpriteSheet::renderRectangleOutline(
 	GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha, GLint leftX, GLint topY, GLint rightX, GLint bottomY)
 {
-	GLfloat lineLeftX = (GLfloat)leftX - 0.5f;
-	GLfloat lineTopY = (GLfloat)topY - 0.5f;
-	GLfloat lineRightX = (GLfloat)rightX + 0.5f;
-	GLfloat lineBottomY = (GLfloat)bottomY + 0.5f;
+	if (activeRectangleRenderer != nullptr) {
+		//match the OpenGL outline, one pixel outside the rectangle
+		setRectangleColorRenderer(red, green, blue, alpha);
+		SDL_Rect rect { (int)leftX - 1, (int)topY - 1, (int)(rightX - leftX) + 2, (int)(bottomY - topY) + 2 };
+		SDL_RenderDrawRect(activeRectangleRenderer, &rect);
+		setRectangleColorRenderer(1.0f, 1.0f, 1.0f, 1.0f);
+		return;
+	}
+	flushBatch();
+	if (recordingCommandList != nullptr) {
+		GLfloat outlineValues[] { red, green, blue, alpha, (GLfloat)leftX, (GLfloat)topY, (GLfloat)rightX, (GLfloat)bottomY };
+		recordingCommandList->addCommand(RenderCommandList::CommandType::RectangleOutline, 0, outlineValues, 8);
+		return;
+	}
+	drawRectangleOutline(red, green, blue, alpha, (GLfloat)leftX, (GLfloat)topY, (GLfloat)rightX, (GLfloat)bottomY);
+}
+void SpriteSheet::drawRectangleOutline(
+	GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha, GLfloat leftX, GLfloat topY, GLfloat rightX, GLfloat bottomY)
+{
+	GLfloat lineLeftX = leftX - 0.5f;
+	GLfloat lineTopY = topY - 0.5f;
+	GLfloat lineRightX = rightX + 0.5f;
+	GLfloat lineBottomY = bottomY + 0.5f;
 	glColor4f(red, green, blue, alpha);
-	//TODO: make this correct
-	glLineWidth(3.0f);
+	//the frame is rendered at native resolution, so this draws one game pixel outside the rectangle
+	glLineWidth(1.0f);
 	glBegin(GL_LINE_LOOP);
 	glVertex2f(lineLeftX, lineTopY);
 	glVertex2f(lineRightX, lineTopY);
 	glVertex2f(lineRightX, lineBottomY);
 	glVertex2f(lineLeftX, lineBottomY);
 	glEnd();
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	setCurrentColor(1.0f, 1.0f, 1.0f, 1.0f);
 }
@@ -1,3 +1,5 @@
+#ifndef SPRITE_SHEET_H
+#define SPRITE_SHEET_H
 #include "General/General.h"
 
 #define newSpriteSheet(imageSurface, horizontalSpriteCount, verticalSpriteCount, hasBottomRightPixelBorder) \
@@ -5,9 +7,78 @@
 #define newSpriteSheetWithImagePath(imagePath, horizontalSpriteCount, verticalSpriteCount, hasBottomRightPixelBorder) \
 	produceWithArgs(SpriteSheet, imagePath, horizontalSpriteCount, verticalSpriteCount, hasBottomRightPixelBorder)
 
+//draw commands recorded by SpriteSheet instead of drawing them, to be drawn later with OpenGL, possibly on another thread
+//held in a shared_ptr so that states that draw the same thing can share one list
+class RenderCommandList {
+	friend class SpriteSheet;
+private:
+	enum class CommandType: unsigned char {
+		//id is the texture, or 0 for untextured rectangles, and the values are the vertices in the batch layout
+		Quads,
+		//id is the texture, or 0 for untextured rectangles, the values are the offset, and the vertices are the next shared
+		//	vertex list
+		SharedQuads,
+		//id is whether blending is enabled
+		SetBlendEnabled,
+		//the values are the color followed by the rectangle
+		RectangleOutline,
+		//the value is the argument to the next OpenGL function
+		OpenGLFunction,
+		//commands until the next EndCameraOffset are offset by how far the camera moved since they were recorded
+		BeginCameraOffset,
+		EndCameraOffset,
+	};
+	//Should only be allocated within an object, on the stack, or as a static object
+	class Command {
+	public:
+		CommandType type;
+		GLuint id;
+		int valuesIndex;
+		int valuesCount;
+
+		Command(CommandType pType, GLuint pId, int pValuesIndex, int pValuesCount);
+		virtual ~Command();
+	};
+
+	vector<Command> commands;
+	vector<GLfloat> values;
+	//these are in the order of the commands that use them
+	vector<shared_ptr<vector<GLfloat>>> sharedVertexLists;
+	vector<void (*)(float)> openGLFunctions;
+
+public:
+	RenderCommandList();
+	virtual ~RenderCommandList();
+
+	//remove all commands and release any shared vertex lists, keeping the memory to record new commands
+	void clear();
+private:
+	//add a command with a copy of the given values
+	void addCommand(CommandType type, GLuint id, const GLfloat* commandValues, int commandValuesCount);
+};
 class SpriteSheet onlyInDebug(: public ObjCounter) {
 private:
+	//x, y, texture x, texture y, red, green, blue, alpha
+	static constexpr int batchVertexFloatCount = 8;
+
 	static SDL_Renderer* activeRectangleRenderer;
+	//without an OpenGL context, sprite sheets only keep their surfaces and can only render with a renderer
+	static bool openGLEnabled;
+	//every sprite sheet that hasn't been deleted, so that they can all get render textures at once
+	static vector<SpriteSheet*> allSpriteSheets;
+	//quads rendered with OpenGL are accumulated here and drawn together, until we need to draw with a different texture or
+	//	something else needs to change the OpenGL state
+	//the update thread records commands while the render thread draws, so each thread has its own batch
+	static thread_local vector<GLfloat> batchVertices;
+	//the texture of the quads in the batch, or 0 for untextured rectangles
+	static thread_local GLuint batchTextureId;
+	//OpenGL uses the same color for sprites and rectangles, so we track it here to write it into every batched vertex
+	static thread_local GLfloat currentRed;
+	static thread_local GLfloat currentGreen;
+	static thread_local GLfloat currentBlue;
+	static thread_local GLfloat currentAlpha;
+	//if set, anything rendered with OpenGL on this thread is recorded into this list instead of drawn
+	static thread_local RenderCommandList* recordingCommandList;
 
 	GLuint textureId;
 	SDL_Surface* renderSurface;
@@ -39,10 +110,54 @@ public:
 		int horizontalSpriteCount,
 		int verticalSpriteCount,
 		bool hasBottomRightPixelBorder);
+private:
+	//flush the batch if it uses a different texture, and get it ready to accept quads with the given texture
+	static void beginBatchQuad(GLuint quadTextureId);
+	//add a vertex to the batch using the current color
+	static void addBatchVertex(GLfloat x, GLfloat y, GLfloat texX, GLfloat texY);
+	//set the current color for both the batch and OpenGL
+	static void setCurrentColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+	//draw quads from vertices in the batch layout with the given texture, or untextured if the texture is 0
+	static void drawVertices(GLuint quadsTextureId, GLfloat* vertexData, int vertexCount);
+	//draw a shared list of quads in the batch layout, offset by the given amount, or record it if we're recording
+	static void renderSharedVertices(
+		GLuint quadsTextureId, const shared_ptr<vector<GLfloat>>& vertices, GLfloat offsetX, GLfloat offsetY);
+	//draw a list of quads in the batch layout, offset by the given amount
+	static void drawVerticesAtOffset(GLuint quadsTextureId, vector<GLfloat>& vertices, GLfloat offsetX, GLfloat offsetY);
+	//draw a one-pixel rectangle outline around the specified region of the screen
+	static void drawRectangleOutline(
+		GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha, GLfloat leftX, GLfloat topY, GLfloat rightX, GLfloat bottomY);
+public:
+	//draw all batched quads
+	//must be called before anything outside of SpriteSheet draws with OpenGL or changes its state
+	static void flushBatch();
+	//draw all batched quads and then enable or disable blending
+	static void setBlendEnabled(bool blendEnabled);
+	//record everything rendered with OpenGL on this thread into the given list instead of drawing it, until endRecording()
+	static void beginRecording(RenderCommandList* commandList);
+	//finish recording and go back to drawing with OpenGL
+	static void endRecording();
+	//draw all the commands in the given list with OpenGL, offsetting camera-offset commands by the given amount
+	static void renderCommands(RenderCommandList* commandList, GLfloat cameraOffsetX, GLfloat cameraOffsetY);
+	//mark that commands recorded until endCameraOffset() are in the world and should follow the camera when they're drawn
+	static void beginCameraOffset();
+	//finish the commands that follow the camera
+	static void endCameraOffset();
+	//draw all batched quads and then call the given function that uses OpenGL directly, or record it to call when the
+	//	commands are drawn
+	static void callOpenGLFunction(void (*openGLFunction)(float), float argument);
 	//render using OpenGL rendering functions
 	static void renderWithOpenGL();
 	//render using SDL_Renderer/SDL_Texture rendering functions
 	static void renderWithRenderer(SDL_Renderer* rectangleRenderer);
+	//whether we're rendering with the SDL_Renderer/SDL_Texture rendering functions
+	static bool isRenderingWithRenderer() { return activeRectangleRenderer != nullptr; }
+	//don't create OpenGL textures for sprite sheets built after this, for rendering without a window
+	static void disableOpenGL() { openGLEnabled = false; }
+	//load a render texture for the given renderer on every sprite sheet
+	static void loadAllRenderTextures(SDL_Renderer* renderer);
+	//destroy the render textures on every sprite sheet
+	static void unloadAllRenderTextures();
 	//load a render texture for the given renderer, writing the old renderer and texture to the given out parameters
 	void loadRenderTexture(SDL_Renderer* renderer, SDL_Renderer** outOldRenderer, SDL_Texture** outOldTexture);
 	//destroy the texture on this SpriteSheet and restore it with the given texture and renderer
@@ -94,6 +209,13 @@ public:
 	//draw the specified sprite image to the renderer with its top-left corner at the specified coordinate
 	void renderSpriteAtScreenPositionRenderer(
 		int spriteHorizontalIndex, int spriteVerticalIndex, GLint drawLeftX, GLint drawTopY);
+	//add a white quad for the specified sprite image with its top-left corner at the specified coordinate to the given list,
+	//	to draw later with renderQuads()
+	void addSpriteQuad(
+		vector<GLfloat>* vertices, int spriteHorizontalIndex, int spriteVerticalIndex, GLfloat drawLeftX, GLfloat drawTopY);
+	//draw quads built with addSpriteQuad(), offset by the given amount
+	//the list may still be drawn after this returns, so it should be replaced instead of changed
+	void renderQuads(const shared_ptr<vector<GLfloat>>& vertices, GLfloat offsetX, GLfloat offsetY);
 	//draw the specified sprite image with its center at the specified coordinate
 	void renderSpriteCenteredAtScreenPosition(
 		int spriteHorizontalIndex, int spriteVerticalIndex, float drawCenterX, float drawCenterY);
@@ -112,7 +234,23 @@ public:
 	static void renderPreColoredRectangleOpenGL(GLint leftX, GLint topY, GLint rightX, GLint bottomY);
 	//render a rectangle with the current color at the specified region in the renderer
 	static void renderPreColoredRectangleRenderer(GLint leftX, GLint topY, GLint rightX, GLint bottomY);
+	//add a rectangle quad using the specified color at the specified coordinates to the given list, to draw later with
+	//	renderRectangleQuads()
+	static void addRectangleQuad(
+		vector<GLfloat>* vertices,
+		GLfloat red,
+		GLfloat green,
+		GLfloat blue,
+		GLfloat alpha,
+		GLfloat leftX,
+		GLfloat topY,
+		GLfloat rightX,
+		GLfloat bottomY);
+	//draw rectangles built with addRectangleQuad(), offset by the given amount
+	//the list may still be drawn after this returns, so it should be replaced instead of changed
+	static void renderRectangleQuads(const shared_ptr<vector<GLfloat>>& vertices, GLfloat offsetX, GLfloat offsetY);
 	//render a rectangle outline using the specified color at the specified region of the screen
 	static void renderRectangleOutline(
 		GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha, GLint leftX, GLint topY, GLint rightX, GLint bottomY);
 };
+#endif
@@ -42,6 +42,15 @@ Text::Glyph* Text::GlyphRow::getGlyph(int unicodeValue) {
 	return (unicodeValue >= unicodeStart && unicodeValue < unicodeEnd) ? glyphs[unicodeValue - unicodeStart] : nullptr;
 }
 
+//////////////////////////////// Text::Run ////////////////////////////////
+Text::Run::Run()
+: glyphs()
+, charactersWidth(0)
+, aboveBaseline(0)
+, belowBaseline(0) {
+}
+Text::Run::~Run() {}
+
 //////////////////////////////// Text::Metrics ////////////////////////////////
 Text::Metrics::Metrics()
 : charactersWidth(0)
@@ -56,6 +65,11 @@ Text::Metrics::~Metrics() {}
 SpriteSheet* Text::font = nullptr;
 SpriteSheet* Text::keyBackground = nullptr;
 vector<Text::GlyphRow*> Text::glyphRows;
+Text::Glyph* Text::asciiGlyphs[Text::asciiGlyphsCount] {};
+atomic<int> Text::fontGeneration (0);
+thread_local unordered_map<string, Text::Run> Text::cachedRuns;
+thread_local int Text::cachedRunsFontGeneration = 0;
+thread_local string Text::cachedRunLookupKey;
 void Text::loadFont() {
 	SDL_Surface* fontSurface = FileUtils::loadImage("font.png");
 	font = newSpriteSheet(fontSurface, 1, 1, false);
@@ -131,6 +145,9 @@ void Text::loadFont() {
 		else
 			headerRow = lowestGlyphBottom + 1;
 	}
+
+	for (int i = 0; i < asciiGlyphsCount; i++)
+		asciiGlyphs[i] = findGlyph(i);
 }
 void Text::unloadFont() {
 	delete font;
@@ -138,14 +155,37 @@ void Text::unloadFont() {
 	for (GlyphRow* glyphRow : glyphRows)
 		delete glyphRow;
 	glyphRows.clear();
+	for (int i = 0; i < asciiGlyphsCount; i++)
+		asciiGlyphs[i] = nullptr;
+	//other threads clear their own cached runs the next time they look one up
+	fontGeneration++;
+}
+Text::Glyph* Text::findGlyph(int unicodeValue) {
+	//binary search for the right glyph row
+	//low equals the lowest index row that could contain it
+	//high equals the highest index row that could contain it
+	int glyphRowLow = 0;
+	int glyphRowHigh = (int)glyphRows.size() - 1;
+	while (glyphRowLow < glyphRowHigh) {
+		int glyphRowMid = (glyphRowLow + glyphRowHigh) / 2;
+		//this row ends after our glyph, so search for an earlier row
+		if (glyphRows[glyphRowMid]->endsAfter(unicodeValue))
+			glyphRowHigh = glyphRowMid;
+		//if it does not end after our glyph, skip it and mark the next row up as our new low
+		else
+			glyphRowLow = glyphRowMid + 1;
+	}
+
+	//this row may or may not contain the glyph, but all lower rows definitely do not contain it
+	return glyphRows[glyphRowLow]->getGlyph(unicodeValue);
 }
 Text::Glyph* Text::getNextGlyph(const char* text, int* inOutCharIndexPointer) {
 	int charIndex = *inOutCharIndexPointer;
 	char c = text[charIndex];
 	int unicodeValue;
 	if ((c & 0x80) == 0) {
-		unicodeValue = (int)c;
 		*inOutCharIndexPointer = charIndex + 1;
+		return asciiGlyphs[(int)c];
 	//2-byte utf-8
 	} else if ((c & 0xE0) == 0xC0) {
 		unicodeValue = (((int)c & 0x1F) << 6) | ((int)text[charIndex + 1] & 0x3F);
@@ -160,48 +200,51 @@ Text::Glyph* Text::getNextGlyph(const char* text, int* inOutCharIndexPointer) {
 		*inOutCharIndexPointer = charIndex + 1;
 		return nullptr;
 	}
-
-	//binary search for the right glyph row
-	//low equals the lowest index row that could contain it
-	//high equals the highest index row that could contain it
-	int glyphRowLow = 0;
-	int glyphRowHigh = (int)glyphRows.size() - 1;
-	while (glyphRowLow < glyphRowHigh) {
-		int glyphRowMid = (glyphRowLow + glyphRowHigh) / 2;
-		//this row ends after our glyph, so search for an earlier row
-		if (glyphRows[glyphRowMid]->endsAfter(unicodeValue))
-			glyphRowHigh = glyphRowMid;
-		//if it does not end after our glyph, skip it and mark the next row up as our new low
-		else
-			glyphRowLow = glyphRowMid + 1;
+	return findGlyph(unicodeValue);
+}
+Text::Run* Text::getRun(const char* text) {
+	//any runs cached before the font was reloaded point to deleted glyphs
+	int currentFontGeneration = fontGeneration;
+	if (cachedRunsFontGeneration != currentFontGeneration) {
+		cachedRuns.clear();
+		cachedRunsFontGeneration = currentFontGeneration;
 	}
 
-	//this row may or may not contain the glyph, but all lower rows definitely do not contain it
-	return glyphRows[glyphRowLow]->getGlyph(unicodeValue);
-}
-Text::Metrics Text::getMetrics(const char* text, float fontScale) {
+	cachedRunLookupKey.assign(text);
+	unordered_map<string, Run>::iterator cachedRun = cachedRuns.find(cachedRunLookupKey);
+	if (cachedRun != cachedRuns.end())
+		return &cachedRun->second;
+
+	//text that changes every frame would keep adding runs, so start over once there are too many
+	if ((int)cachedRuns.size() >= maxCachedRunsCount)
+		cachedRuns.clear();
+	Run* run = &cachedRuns[cachedRunLookupKey];
 	int charIndex = 0;
-	int charactersWidth = 0;
-	int aboveBaseline = 0;
-	int belowBaseline = 0;
 	while (text[charIndex] != 0) {
 		Glyph* glyph = getNextGlyph(text, &charIndex);
+		//skip any characters that the font doesn't have
+		if (glyph == nullptr)
+			continue;
 		int glyphBaselineOffset = glyph->getBaselineOffset();
 
-		charactersWidth += glyph->getWidth() + defaultInterCharacterSpacing;
-		aboveBaseline = MathUtils::max(aboveBaseline, glyph->getHeight() - glyphBaselineOffset);
-		belowBaseline = MathUtils::max(belowBaseline, glyphBaselineOffset);
+		run->glyphs.push_back(glyph);
+		run->charactersWidth += glyph->getWidth() + defaultInterCharacterSpacing;
+		run->aboveBaseline = MathUtils::max(run->aboveBaseline, glyph->getHeight() - glyphBaselineOffset);
+		run->belowBaseline = MathUtils::max(run->belowBaseline, glyphBaselineOffset);
 	}
 
-	if (charactersWidth > 0)
-		charactersWidth -= defaultInterCharacterSpacing;
-
+	if (run->charactersWidth > 0)
+		run->charactersWidth -= defaultInterCharacterSpacing;
+	return run;
+}
+Text::Metrics Text::getMetrics(const char* text, float fontScale) {
+	Run* run = getRun(text);
 	static constexpr int defaultTopPadding = 1;
 	static constexpr int defaultBottomPadding = 1;
 	Metrics metrics;
-	metrics.charactersWidth = (float)charactersWidth * fontScale;
-	metrics.aboveBaseline = (float)aboveBaseline * fontScale;
-	metrics.belowBaseline = (float)belowBaseline * fontScale;
+	metrics.charactersWidth = (float)run->charactersWidth * fontScale;
+	metrics.aboveBaseline = (float)run->aboveBaseline * fontScale;
+	metrics.belowBaseline = (float)run->belowBaseline * fontScale;
 	metrics.topPadding = (float)defaultTopPadding * fontScale;
 	metrics.bottomPadding = (float)defaultBottomPadding * fontScale;
 	metrics.fontScale = fontScale;
@@ -223,9 +266,7 @@ Text::Metrics Text::getKeyBackgroundMetrics(Metrics* textMetrics) {
 	return metrics;
 }
 void Text::render(const char* text, float leftX, float baselineY, float fontScale) {
-	int charIndex = 0;
-	while (text[charIndex] != 0) {
-		Glyph* glyph = getNextGlyph(text, &charIndex);
+	for (Glyph* glyph : getRun(text)->glyphs) {
 		int glyphSpriteX = glyph->getSpriteX();
 		int glyphSpriteY = glyph->getSpriteY();
 		int glyphWidth = glyph->getWidth();
@@ -43,6 +43,19 @@ private:
 		//returns the glyph associated with the given unicode value, or nullptr if this row does not contain it
 		Glyph* getGlyph(int unicodeValue);
 	};
+	//the glyphs of a string, laid out once so that it can be measured and rendered repeatedly
+	//Should only be allocated within an object, on the stack, or as a static object
+	class Run {
+	public:
+		vector<Glyph*> glyphs;
+		//these are unscaled
+		int charactersWidth;
+		int aboveBaseline;
+		int belowBaseline;
+
+		Run();
+		virtual ~Run();
+	};
 public:
 	//Should only be allocated within an object, on the stack, or as a static object
 	class Metrics {
@@ -65,10 +78,22 @@ public:
 
 private:
 	static constexpr int defaultInterCharacterSpacing = 1;
+	static constexpr int asciiGlyphsCount = 128;
+	static constexpr int maxCachedRunsCount = 256;
 
 	static SpriteSheet* font;
 	static SpriteSheet* keyBackground;
 	static vector<GlyphRow*> glyphRows;
+	//indexed by character, so that ASCII text doesn't need to search the glyph rows
+	static Glyph* asciiGlyphs[asciiGlyphsCount];
+	//incremented every time the font is unloaded, so that runs cached with its glyphs are never used after they're deleted
+	static atomic<int> fontGeneration;
+	//text is laid out on both the update and render threads, so each thread caches its own runs
+	static thread_local unordered_map<string, Run> cachedRuns;
+	//the font generation of the glyphs in this thread's cached runs
+	static thread_local int cachedRunsFontGeneration;
+	//reused to look up runs without allocating a new string every time
+	static thread_local string cachedRunLookupKey;
 
 public:
 	//Prevent allocation
@@ -79,8 +104,16 @@ public:
 	static void loadFont();
 	//delete the font sprite sheet
 	static void unloadFont();
+private:
+	//find the glyph for the given unicode value, or nullptr if the font doesn't have one
+	static Glyph* findGlyph(int unicodeValue);
+public:
 	//return the glyph as indicated by the character at the given index, and increment the index to the following character
 	static Glyph* getNextGlyph(const char* text, int* inOutCharIndexPointer);
+private:
+	//get the glyphs and unscaled metrics of the given text, laying it out and caching it if it hasn't been already
+	static Run* getRun(const char* text);
+public:
 	//get the metrics of the text that would be drawn by drawing the given text at the given font scale
 	static Metrics getMetrics(const char* text, float fontScale);
 	//get the metrics of the key background for text of the given width
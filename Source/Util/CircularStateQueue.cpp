@@ -20,17 +20,22 @@ template <class Type>
 CircularStateQueue<Type>::CircularStateQueue(objCounterParametersComma() Type* writeHeadState, Type* nextState)
 : onlyInDebug(ObjCounter(objCounterArguments()) COMMA)
 writeHead(newNode(writeHeadState))
+, statesCount(2)
+, statesProducedCount(0)
+, producerStallsCount(0)
 , readHead(nullptr)
 , lastStateWasRead(true)
-, statesCount(2) {
+, statesSkippedCount(0) {
+	Node* writeHeadNode = writeHead.load(memory_order_relaxed);
 	Node* next = newNode(nextState);
-	writeHead->next = next;
-	next->next = writeHead;
-	readHead = writeHead;
+	writeHeadNode->next = next;
+	next->next = writeHeadNode;
+	readHead.store(writeHeadNode, memory_order_relaxed);
 }
 template <class Type> CircularStateQueue<Type>::~CircularStateQueue() {
-	Node* node = writeHead->next;
-	writeHead->next = nullptr;
+	Node* writeHeadNode = writeHead.load(memory_order_relaxed);
+	Node* node = writeHeadNode->next;
+	writeHeadNode->next = nullptr;
 	while (node != nullptr) {
 		Node* nodeToDelete = node;
 		node = node->next;
@@ -38,43 +43,57 @@ template <class Type> CircularStateQueue<Type>::~CircularStateQueue() {
 	}
 }
 template <class Type> Type* CircularStateQueue<Type>::getNextWritableState() {
-	return writeHead->next != readHead ? writeHead->next->state : nullptr;
+	//acquire the read head so that we know the consumer is done reading any state before we write to it
+	Node* next = writeHead.load(memory_order_relaxed)->next;
+	if (next != readHead.load(memory_order_acquire))
+		return next->state;
+	return nullptr;
 }
 template <class Type> void CircularStateQueue<Type>::addWritableState(Type* state) {
+	//the consumer never reads the write head's next node until after we advance the write head past it, so we can safely
+	//	insert a node here
+	Node* writeHeadNode = writeHead.load(memory_order_relaxed);
 	Node* nextWritableNode = newNode(state);
-	nextWritableNode->next = writeHead->next;
-	writeHead->next = nextWritableNode;
+	nextWritableNode->next = writeHeadNode->next;
+	writeHeadNode->next = nextWritableNode;
 	statesCount++;
 }
 template <class Type> void CircularStateQueue<Type>::finishWritingToState() {
-	writeHead = writeHead->next;
+	//release the write head so that everything written to the state is visible to the consumer once it sees the new head
+	writeHead.store(writeHead.load(memory_order_relaxed)->next, memory_order_release);
+	statesProducedCount++;
 }
 template <class Type> Type* CircularStateQueue<Type>::getNextReadableState() {
+	Node* readHeadNode = readHead.load(memory_order_relaxed);
 	//we haven't read from the read head yet, return the state
 	if (!lastStateWasRead)
-		return readHead->state;
+		return readHeadNode->state;
 	//we already read from the read head, but there's another state available, advance to it and return it
-	else if (readHead != writeHead) {
-		readHead = readHead->next;
+	else if (readHeadNode != writeHead.load(memory_order_acquire)) {
+		readHeadNode = readHeadNode->next;
+		readHead.store(readHeadNode, memory_order_release);
 		lastStateWasRead = false;
-		return readHead->state;
+		return readHeadNode->state;
 	//we already read from the read head and there is no other state available
 	} else
 		return nullptr;
 }
 template <class Type> void CircularStateQueue<Type>::finishReadingFromState() {
-	if (readHead == writeHead)
+	Node* readHeadNode = readHead.load(memory_order_relaxed);
+	if (readHeadNode == writeHead.load(memory_order_acquire))
 		lastStateWasRead = true;
+	//release the read head so that the producer knows we're done reading the old one
 	else
-		readHead = readHead->next;
+		readHead.store(readHeadNode->next, memory_order_release);
 }
 template <class Type> Type* CircularStateQueue<Type>::advanceToLastReadableState() {
 	Type* state = getNextReadableState();
 	if (state == nullptr)
 		return nullptr;
-	while (readHead != writeHead) {
+	while (readHead.load(memory_order_relaxed) != writeHead.load(memory_order_acquire)) {
 		finishReadingFromState();
 		state = getNextReadableState();
+		statesSkippedCount++;
 	}
 	return state;
 }
@@ -2,10 +2,15 @@
 
 #define newCircularStateQueue(type, writeHeadState, nextState) newWithArgs(CircularStateQueue<type>, writeHeadState, nextState)
 
+//a single-producer single-consumer queue of states
+//the producer owns the write head and the consumer owns the read head, and each one only reads the other's head, with
+//	release stores and acquire loads to make sure that a state is fully written before it's read and fully read before it's
+//	written again
 template <class Type> class CircularStateQueue onlyInDebug(: public ObjCounter) {
 private:
 	class Node onlyInDebug(: public ObjCounter) {
 	public:
+		//only the producer changes this, and only on the write head node, which the consumer never reads past
 		Node* next;
 		Type* state;
 
@@ -13,20 +18,35 @@ private:
 		virtual ~Node();
 	};
 
+	static const int cacheLineSize = 64;
+
+	//producer data, kept on its own cache line so that the consumer doesn't contend with the producer for it
 	//writeHead always points to the most recently written state
-	Node* writeHead;
+	alignas(cacheLineSize) atomic<Node*> writeHead;
+	int statesCount;
+	int statesProducedCount;
+	int producerStallsCount;
+	//consumer data
 	//if lastStateWasRead is true, readHead points to the most recently read state
 	//if lastStateWasRead is false, readHead points to the next readable state
-	Node* readHead;
+	alignas(cacheLineSize) atomic<Node*> readHead;
 	//signals whether the read head has already been read
 	bool lastStateWasRead;
-	int statesCount;
+	int statesSkippedCount;
 
 public:
 	CircularStateQueue(objCounterParametersComma() Type* writeHeadState, Type* nextState);
 	virtual ~CircularStateQueue();
 
+	//these should only be called from the producer thread
 	int getStatesCount() { return statesCount; }
+	int getStatesProducedCount() { return statesProducedCount; }
+	int getProducerStallsCount() { return producerStallsCount; }
+	//track that the producer couldn't get or add a writable state, and had to wait for the consumer instead
+	//not having a writable state isn't a stall on its own if the producer can add one
+	void markProducerStalled() { producerStallsCount++; }
+	//this should only be called from the consumer thread, or after it's finished
+	int getStatesSkippedCount() { return statesSkippedCount; }
 	//if the write head's next state is writable, return it
 	Type* getNextWritableState();
 	//insert a writable state after the write head
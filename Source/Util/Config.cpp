@@ -141,6 +141,7 @@ OnOffSetting Config::autosaveAtIntervalsEnabled ("autosaveAtIntervalsEnabled ",
 OnOffSetting Config::autosaveEveryNewLevelEnabled ("autosaveEveryNewLevelEnabled ", Config::allMultiStateSettings);
 MultiStateSetting Config::solutionBlockedWarning(
 	{ "strict", "loose", "off" }, "solutionBlockedWarning ", Config::allMultiStateSettings);
+MultiStateSetting Config::upscaleFilter ({ "pixellated", "sharp bilinear" }, "upscaleFilter ", Config::allMultiStateSettings);
 vector<ValueSelectionSetting*> Config::allValueSelectionSettings;
 ValueSelectionSetting Config::autosaveInterval (
 	{
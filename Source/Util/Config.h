@@ -102,6 +102,8 @@ public:
 	static constexpr int editorMarginBottom = 60;
 	static constexpr int ticksPerSecond = 1000;
 	static constexpr int updatesPerSecond = 48;
+	//the approximate memory that each of the undo and redo stacks may use before the oldest states are discarded
+	static constexpr int undoHistoryMaxBytes = 1024 * 1024;
 	static constexpr float defaultPixelWidth = 4.0f;
 	static constexpr float defaultPixelHeight = 4.0f;
 	static constexpr float editorDefaultPixelWidth = 3.0f;
@@ -114,6 +116,7 @@ public:
 	static constexpr int heightBasedShadingExtraValue = 2;
 	static constexpr int solutionBlockedWarningLooseValue = 1;
 	static constexpr int solutionBlockedWarningOffValue = 2;
+	static constexpr int upscaleFilterSharpBilinearValue = 1;
 
 	static float currentPixelWidth;
 	static float currentPixelHeight;
@@ -146,6 +149,7 @@ public:
 	static ConfigTypes::OnOffSetting autosaveAtIntervalsEnabled;
 	static ConfigTypes::OnOffSetting autosaveEveryNewLevelEnabled;
 	static ConfigTypes::MultiStateSetting solutionBlockedWarning;
+	static ConfigTypes::MultiStateSetting upscaleFilter;
 	static vector<ConfigTypes::ValueSelectionSetting*> allValueSelectionSettings;
 	static ConfigTypes::ValueSelectionSetting autosaveInterval;
 	static vector<ConfigTypes::VolumeSetting*> allVolumeSettings;
@@ -1,5 +1,4 @@
 #include "PooledReferenceCounter.h"
-#include "GameState/CollisionRect.h"
 #include "GameState/DynamicValue.h"
 #include "GameState/EntityAnimation.h"
 #include "GameState/EntityState.h"
@@ -15,6 +14,10 @@
 #define ENABLE_POOLING
 
 //////////////////////////////// PooledReferenceCounter ////////////////////////////////
+#ifdef TRACK_REFERENCE_COUNT_STATS
+	thread_local int PooledReferenceCounter::retainsCount = 0;
+	thread_local int PooledReferenceCounter::releasesCount = 0;
+#endif
 PooledReferenceCounter::PooledReferenceCounter(objCounterParameters())
 : onlyInDebug(ObjCounter(objCounterArguments()) COMMA)
 referenceCount(0) {
@@ -36,10 +39,10 @@ ReferenceCounterHolder<ReferenceCountedObject>::ReferenceCounterHolder(
 		object->retain();
 }
 template <class ReferenceCountedObject>
-ReferenceCounterHolder<ReferenceCountedObject>::ReferenceCounterHolder(ReferenceCounterHolder<ReferenceCountedObject>&& other)
+ReferenceCounterHolder<ReferenceCountedObject>::ReferenceCounterHolder(
+	ReferenceCounterHolder<ReferenceCountedObject>&& other) noexcept
 : object(other.object) {
-	if (object != nullptr)
-		object->retain();
+	other.object = nullptr;
 }
 template <class ReferenceCountedObject> ReferenceCounterHolder<ReferenceCountedObject>::~ReferenceCounterHolder() {
 	if (object != nullptr)
@@ -69,33 +72,120 @@ ReferenceCounterHolder<ReferenceCountedObject>& ReferenceCounterHolder<Reference
 }
 template <class ReferenceCountedObject>
 ReferenceCounterHolder<ReferenceCountedObject>& ReferenceCounterHolder<ReferenceCountedObject>::operator =(
-	ReferenceCounterHolder<ReferenceCountedObject>&& other)
+	ReferenceCounterHolder<ReferenceCountedObject>&& other) noexcept
 {
-	set(other.object);
+	if (&other != this) {
+		ReferenceCountedObject* oldObject = object;
+		object = other.object;
+		other.object = nullptr;
+		if (oldObject != nullptr)
+			oldObject->release();
+	}
 	return *this;
 }
 
 //////////////////////////////// ObjectPool ////////////////////////////////
-template <class PooledObject> vector<PooledObject*> ObjectPool<PooledObject>::pool;
+template <class PooledObject> thread_local typename ObjectPool<PooledObject>::ThreadCache ObjectPool<PooledObject>::threadCache;
+template <class PooledObject> mutex ObjectPool<PooledObject>::depotMutex;
+template <class PooledObject> vector<PooledObject*> ObjectPool<PooledObject>::depot;
+template <class PooledObject> vector<char*> ObjectPool<PooledObject>::slabs;
+template <class PooledObject> int ObjectPool<PooledObject>::nextSlabObjectIndex = ObjectPool<PooledObject>::slabObjectCount;
+template <class PooledObject> int ObjectPool<PooledObject>::constructedCount = 0;
+template <class PooledObject> atomic<int> ObjectPool<PooledObject>::liveCount (0);
+template <class PooledObject> atomic<int> ObjectPool<PooledObject>::highWaterMark (0);
+template <class PooledObject> ObjectPool<PooledObject>::ThreadCache::ThreadCache()
+: objects() {
+}
+template <class PooledObject> ObjectPool<PooledObject>::ThreadCache::~ThreadCache() {
+	if (!objects.empty())
+		flushThreadCache(objects, (int)objects.size());
+}
+template <class PooledObject> int ObjectPool<PooledObject>::getSlabMemoryBytes() {
+	depotMutex.lock();
+	int slabMemoryBytes = (int)slabs.size() * slabObjectCount * (int)sizeof(PooledObject);
+	depotMutex.unlock();
+	return slabMemoryBytes;
+}
 template <class PooledObject> PooledObject* ObjectPool<PooledObject>::newFromPool(objCounterParameters()) {
-	if (!pool.empty()) {
-		PooledObject* p = pool.back();
-		pool.pop_back();
+	int newLiveCount = liveCount.fetch_add(1, memory_order_relaxed) + 1;
+	int oldHighWaterMark = highWaterMark.load(memory_order_relaxed);
+	while (newLiveCount > oldHighWaterMark
+			&& !highWaterMark.compare_exchange_weak(oldHighWaterMark, newLiveCount, memory_order_relaxed))
+		;
+	#ifdef ENABLE_POOLING
+		vector<PooledObject*>& cachedObjects = threadCache.objects;
+		if (cachedObjects.empty())
+			refillThreadCache(objCounterArguments());
+		PooledObject* p = cachedObjects.back();
+		cachedObjects.pop_back();
 		return p;
-	}
-	return new PooledObject(objCounterArguments());
+	#else
+		return new PooledObject(objCounterArguments());
+	#endif
 }
 template <class PooledObject> void ObjectPool<PooledObject>::returnToPool(PooledObject* p) {
+	liveCount.fetch_sub(1, memory_order_relaxed);
 	#ifdef ENABLE_POOLING
-		pool.push_back(p);
+		vector<PooledObject*>& cachedObjects = threadCache.objects;
+		cachedObjects.push_back(p);
+		if ((int)cachedObjects.size() >= maxThreadCacheCount)
+			flushThreadCache(cachedObjects, threadCacheTransferCount);
 	#else
 		delete p;
 	#endif
 }
+template <class PooledObject> void ObjectPool<PooledObject>::prewarmSlab(objCounterParameters()) {
+	#ifdef ENABLE_POOLING
+		depotMutex.lock();
+		do {
+			depot.push_back(constructSlabObject(objCounterArguments()));
+		} while (nextSlabObjectIndex < slabObjectCount);
+		depotMutex.unlock();
+	#endif
+}
 template <class PooledObject> void ObjectPool<PooledObject>::clearPool() {
-	for (PooledObject* p : pool)
-		delete p;
-	pool.clear();
+	vector<PooledObject*>& cachedObjects = threadCache.objects;
+	if (!cachedObjects.empty())
+		flushThreadCache(cachedObjects, (int)cachedObjects.size());
+	depotMutex.lock();
+	for (PooledObject* p : depot)
+		p->~PooledObject();
+	constructedCount -= (int)depot.size();
+	depot.clear();
+	if (constructedCount == 0) {
+		for (char* slab : slabs)
+			delete[] slab;
+		slabs.clear();
+		nextSlabObjectIndex = slabObjectCount;
+	}
+	depotMutex.unlock();
+}
+template <class PooledObject> PooledObject* ObjectPool<PooledObject>::constructSlabObject(objCounterParameters()) {
+	if (nextSlabObjectIndex == slabObjectCount) {
+		slabs.push_back(new char[slabObjectCount * sizeof(PooledObject)]);
+		nextSlabObjectIndex = 0;
+	}
+	char* slot = slabs.back() + nextSlabObjectIndex * sizeof(PooledObject);
+	nextSlabObjectIndex++;
+	constructedCount++;
+	return new (slot) PooledObject(objCounterArguments());
+}
+template <class PooledObject> void ObjectPool<PooledObject>::refillThreadCache(objCounterParameters()) {
+	vector<PooledObject*>& cachedObjects = threadCache.objects;
+	depotMutex.lock();
+	int depotTransferCount = MathUtils::min(threadCacheTransferCount, (int)depot.size());
+	cachedObjects.insert(cachedObjects.end(), depot.end() - depotTransferCount, depot.end());
+	depot.resize(depot.size() - depotTransferCount);
+	//only construct what we need right now, pre-warmed pools will already have objects in the depot
+	if (depotTransferCount == 0)
+		cachedObjects.push_back(constructSlabObject(objCounterArguments()));
+	depotMutex.unlock();
+}
+template <class PooledObject> void ObjectPool<PooledObject>::flushThreadCache(vector<PooledObject*>& cachedObjects, int count) {
+	depotMutex.lock();
+	depot.insert(depot.end(), cachedObjects.end() - count, cachedObjects.end());
+	depotMutex.unlock();
+	cachedObjects.resize(cachedObjects.size() - count);
 }
 
 //many subclasses only need their own pool, they are not held as the subclass itself
@@ -133,7 +223,6 @@ template class ReferenceCounterHolder<EntityAnimationTypes::Component>;
 template class ReferenceCounterHolder<EntityState>;
 template class ReferenceCounterHolder<UndoState>;
 //solo-concrete classes or held subclasses need both their own pools and holders
-instantiateObjectPoolAndReferenceCounterHolder(CollisionRect)
 instantiateObjectPoolAndReferenceCounterHolder(DynamicCameraAnchor)
 instantiateObjectPoolAndReferenceCounterHolder(EntityAnimation)
 instantiateObjectPoolAndReferenceCounterHolder(HintState)
@@ -2,9 +2,18 @@
 #define POOLED_REFERENCE_COUNTER_H
 #include "General/General.h"
 
+#ifdef DEBUG
+	//#define TRACK_REFERENCE_COUNT_STATS
+#endif
+#ifdef TRACK_REFERENCE_COUNT_STATS
+	#define countReferenceRelease() releasesCount++;
+#else
+	#define countReferenceRelease()
+#endif
 #define initializeWithNewFromPool(var, className) className* var = ObjectPool<className>::newFromPool(objCounterArguments());
 #define pooledReferenceCounterDefineRelease(className) \
 	void className::release() {\
+		countReferenceRelease()\
 		referenceCount--;\
 		if (referenceCount == 0) {\
 			prepareReturnToPool();\
@@ -13,6 +22,12 @@
 	}
 
 class PooledReferenceCounter onlyInDebug(: public ObjCounter) {
+public:
+	#ifdef TRACK_REFERENCE_COUNT_STATS
+		//counts of retains and releases performed on the current thread
+		static thread_local int retainsCount;
+		static thread_local int releasesCount;
+	#endif
 protected:
 	int referenceCount;
 
@@ -25,7 +40,12 @@ protected:
 	virtual void prepareReturnToPool() {}
 public:
 	//increment the reference count of this object
-	void retain() { referenceCount++; }
+	void retain() {
+		#ifdef TRACK_REFERENCE_COUNT_STATS
+			retainsCount++;
+		#endif
+		referenceCount++;
+	}
 	//release a reference to this PooledReferenceCounter and return it to the pool if applicable
 	virtual void release() = 0;
 };
@@ -37,7 +57,8 @@ private:
 public:
 	ReferenceCounterHolder(ReferenceCountedObject* pObject);
 	ReferenceCounterHolder(const ReferenceCounterHolder<ReferenceCountedObject>& other);
-	ReferenceCounterHolder(ReferenceCounterHolder<ReferenceCountedObject>&& other);
+	//take the object from the other holder without retaining it
+	ReferenceCounterHolder(ReferenceCounterHolder<ReferenceCountedObject>&& other) noexcept;
 	virtual ~ReferenceCounterHolder();
 
 	ReferenceCountedObject* get() const { return object; }
@@ -47,20 +68,76 @@ public:
 	void clear();
 
 	ReferenceCounterHolder<ReferenceCountedObject>& operator =(const ReferenceCounterHolder<ReferenceCountedObject>& other);
-	ReferenceCounterHolder<ReferenceCountedObject>& operator =(ReferenceCounterHolder<ReferenceCountedObject>&& other);
+	//release our object and take the object from the other holder without retaining it
+	ReferenceCounterHolder<ReferenceCountedObject>& operator =(ReferenceCounterHolder<ReferenceCountedObject>&& other) noexcept;
 };
+//a non-owning reference to a reference counted object, used to pass objects to functions without retaining or releasing them
+//the object must stay retained by something else, or be retained by the function it's passed to
+//Should only be allocated on the stack
+template <class ReferenceCountedObject> class ReferenceCounterBorrow {
+private:
+	ReferenceCountedObject* object;
+
+public:
+	ReferenceCounterBorrow(ReferenceCountedObject* pObject): object(pObject) {}
+	ReferenceCounterBorrow(const ReferenceCounterHolder<ReferenceCountedObject>& holder): object(holder.get()) {}
+
+	ReferenceCountedObject* get() const { return object; }
+};
+//objects are constructed in contiguous slabs and never freed individually; a freed object goes to the current thread's cache,
+//	and batches of objects move between thread caches and a locked depot shared by all threads
 template <class PooledObject> class ObjectPool {
 private:
-	static vector<PooledObject*> pool;
+	//Should only be allocated within an object, on the stack, or as a static object
+	class ThreadCache {
+	public:
+		vector<PooledObject*> objects;
+
+		ThreadCache();
+		//return any cached objects to the depot when the thread exits
+		virtual ~ThreadCache();
+	};
+
+	static constexpr int slabTargetBytes = 16384;
+	static constexpr int slabObjectCount =
+		(int)sizeof(PooledObject) >= slabTargetBytes ? 1 : slabTargetBytes / (int)sizeof(PooledObject);
+	static constexpr int threadCacheTransferCount = 32;
+	static constexpr int maxThreadCacheCount = threadCacheTransferCount * 2;
+
+	static thread_local ThreadCache threadCache;
+	static mutex depotMutex;
+	static vector<PooledObject*> depot;
+	static vector<char*> slabs;
+	static int nextSlabObjectIndex;
+	static int constructedCount;
+	static atomic<int> liveCount;
+	static atomic<int> highWaterMark;
 
 public:
 	//Prevent allocation
 	ObjectPool() = delete;
-	//if we have objects in the pool then remove one and return it, otherwise make a new object
+	static int getLiveCount() { return liveCount.load(memory_order_relaxed); }
+	static int getHighWaterMark() { return highWaterMark.load(memory_order_relaxed); }
+	//return the number of bytes of slab memory allocated for this pool
+	static int getSlabMemoryBytes();
+	//take an object from this thread's cache, refilling it from the depot or new slab objects if it's empty
 	static PooledObject* newFromPool(objCounterParameters());
-	//add this object back to the pool
+	//add this object back to this thread's cache, moving a batch to the depot if it's full
 	static void returnToPool(PooledObject* p);
-	//clear the pool, deleting all the objects in it
+	//construct every remaining object in the last slab into the depot, adding a slab first if it's full, so that they can be
+	//	handed out without constructing them one at a time
+	//for a pool that hasn't been used yet, this allocates the same slab its first object would
+	static void prewarmSlab(objCounterParameters());
+	//clear the pool, deleting all the objects in it and this thread's cache
+	//slabs are only freed once every object constructed in them has been returned, and other threads must have exited
 	static void clearPool();
+private:
+	//construct a new object in the next free spot of the last slab, adding a slab if needed
+	//must be called while holding the depot mutex
+	static PooledObject* constructSlabObject(objCounterParameters());
+	//move objects from the depot into this thread's cache, constructing a new one if the depot is empty
+	static void refillThreadCache(objCounterParameters());
+	//move the given number of objects from the end of the thread cache into the depot
+	static void flushThreadCache(vector<PooledObject*>& cachedObjects, int count);
 };
 #endif
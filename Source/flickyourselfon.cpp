@@ -2,7 +2,6 @@
 #include <time.h>
 #include "Audio/Audio.h"
 #include "Editor/Editor.h"
-#include "GameState/CollisionRect.h"
 #include "GameState/DynamicValue.h"
 #include "GameState/EntityAnimation.h"
 #include "GameState/EntityState.h"
@@ -10,6 +9,7 @@
 #include "GameState/HintState.h"
 #include "GameState/KickAction.h"
 #include "GameState/PauseState.h"
+#include "GameState/PlayerState.h"
 #include "GameState/UndoState.h"
 #include "GameState/MapState/MapState.h"
 #include "Sprites/SpriteRegistry.h"
@@ -24,10 +24,22 @@
 #include "Util/Logger.h"
 #include "Util/TimeUtils.h"
 
+#define prewarmObjectPool(className) ObjectPool<className>::prewarmSlab(objCounterLocalArguments(className))
+#ifdef DEBUG
+	#define logPoolStats(className, message) logPoolStatsForClass<className>(#className, message)
+#endif
+
 const int maxGameStates = 6;
+const int maxIdleRenderDelay = 250;
 SDL_Window* window = nullptr;
 mutex renderThreadInitializingMutex;
 bool renderThreadInitialized = false;
+atomic<bool> firstGameStateRendered (false);
+//set by the update thread whenever it records new render commands, so that the render thread can sleep until then when
+//	nothing is animating
+mutex gameStateRecordedMutex;
+condition_variable gameStateRecordedCondition;
+bool gameStateRecorded = false;
 bool criticalError = false;
 
 int gameMain(int argc, char* argv[]) {
@@ -46,6 +58,11 @@ int gameMain(int argc, char* argv[]) {
 			return 1;
 	#endif
 
+	#ifdef DEBUG
+		bool testSolutions = false;
+		bool benchmarkRender = false;
+		bool saveBenchmarkRenderImages = false;
+	#endif
 	for (int i = 1; i < argc; i++) {
 		if (strcmp(argv[i], "--editor") == 0 && !Editor::isActive) {
 			Editor::isActive = true;
@@ -59,6 +76,16 @@ int gameMain(int argc, char* argv[]) {
 			else if (strcmp(argv[i], "--fix-achievements") == 0)
 				Steam::setFixLevelEndAchievements();
 		#endif
+		#ifdef DEBUG
+			else if (strcmp(argv[i], "--test-solutions") == 0)
+				testSolutions = true;
+			else if (strcmp(argv[i], "--benchmark-render") == 0)
+				benchmarkRender = true;
+			else if (strcmp(argv[i], "--benchmark-render-images") == 0) {
+				benchmarkRender = true;
+				saveBenchmarkRenderImages = true;
+			}
+		#endif
 	}
 
 	//some things need to happen before logging can begin
@@ -74,6 +101,47 @@ int gameMain(int argc, char* argv[]) {
 	Logger::beginMultiThreadedLogging();
 	Logger::setupLogQueue("M");
 
+	#ifdef DEBUG
+		//verify all the level solutions without opening a window, and exit with an error if any of them failed
+		if (testSolutions) {
+			Logger::debugLogger.log("Logging set up /// Testing solutions...");
+			MapState::buildMap();
+			int failedSolutionsCount = MapState::testAllSolutions();
+			Logger::endMultiThreadedLogging();
+			MapState::deleteMap();
+			ObjectPool<HintState::PotentialLevelState>::clearPool();
+			ObjCounter::end();
+			Logger::gameplayLogger.endLogging();
+			Logger::debugLogger.log("Solutions tested");
+			Logger::debugLogger.endLogging();
+			SDL_Quit();
+			return failedSolutionsCount > 0 ? 1 : 0;
+		}
+		//render gameplay frames with the software renderer without opening a window, and log how long they took
+		if (benchmarkRender) {
+			Logger::debugLogger.log("Logging set up /// Benchmarking rendering...");
+			MapState::buildMap();
+			SpriteSheet::disableOpenGL();
+			Text::loadFont();
+			SpriteRegistry::loadAll();
+			GameState::benchmarkRender(saveBenchmarkRenderImages);
+			SpriteRegistry::unloadAll();
+			Text::unloadFont();
+			Logger::endMultiThreadedLogging();
+			MapState::deleteMap();
+			ObjectPool<PlayerState>::clearPool();
+			ObjectPool<MapState>::clearPool();
+			ObjectPool<DynamicCameraAnchor>::clearPool();
+			ObjectPool<ConstantValue>::clearPool();
+			ObjCounter::end();
+			Logger::gameplayLogger.endLogging();
+			Logger::debugLogger.log("Rendering benchmarked");
+			Logger::debugLogger.endLogging();
+			SDL_Quit();
+			return 0;
+		}
+	#endif
+
 	Logger::debugLogger.log("SDL set up /// Setting up window...");
 
 	//create a window
@@ -117,13 +185,16 @@ int gameMain(int argc, char* argv[]) {
 	Config::loadSettings();
 	Audio::applyVolume();
 	MapState::buildMap();
+	prewarmObjectPools();
 	PauseState::loadMenus();
 	if (Editor::isActive)
 		Editor::loadButtons();
 
 	//load the initial game state
 	Logger::debugLogger.log("Game world loaded /// Loading game state...");
-	prevGameState->loadInitialState((int)SDL_GetTicks());
+	int initialStateTicksTime = (int)SDL_GetTicks();
+	prevGameState->loadInitialState(initialStateTicksTime);
+	prevGameState->recordRenderCommands(nullptr, initialStateTicksTime);
 	gameStateQueue->finishWritingToState();
 	stringstream beginGameplayMessage;
 	beginGameplayMessage << "---- begin gameplay ---- ";
@@ -135,13 +206,30 @@ int gameMain(int argc, char* argv[]) {
 	int updateDelay = -1;
 	int startTime = 0;
 	int updateNum = 0;
+	bool hintPrefetchBegan = false;
+	#ifdef TRACK_REFERENCE_COUNT_STATS
+		int gameStatesUpdatedCount = 0;
+		PooledReferenceCounter::retainsCount = 0;
+		PooledReferenceCounter::releasesCount = 0;
+	#endif
 	while (true) {
+		//once the player can see the game, use idle time to prefetch level start state hints
+		//the editor changes levels as it runs, so don't prefetch hints for them
+		if (!hintPrefetchBegan && firstGameStateRendered && !Editor::isActive) {
+			PlayerState::beginHintPrefetch();
+			hintPrefetchBegan = true;
+		}
+
 		//if we missed an update or haven't begun the loop, reset the update number and time
 		if (updateDelay <= 0) {
 			updateNum = 0;
 			startTime = (int)SDL_GetTicks();
-		} else
+		} else if (prevGameState->isAnimating())
 			SDL_Delay((Uint32)updateDelay);
+		//nothing changes on its own, so only an event can change anything before the next update; wake up for one right
+		//	away, or for the next update anyways to collect anything that finished on another thread
+		else
+			SDL_WaitEventTimeout(nullptr, updateDelay);
 
 		GameState* gameState = gameStateQueue->getNextWritableState();
 		//add a new state if there isn't one we can write to and we haven't reached our limit
@@ -152,13 +240,27 @@ int gameMain(int argc, char* argv[]) {
 		}
 
 		//skip the update if we couldn't get a state to render to, leave prevGameState as it was
+		//once the state is updated, record its render commands so that the render thread only needs to draw them
 		if (gameState != nullptr) {
-			gameState->updateWithPreviousGameState(prevGameState, (int)SDL_GetTicks());
+			int updateTicksTime = (int)SDL_GetTicks();
+			gameState->updateWithPreviousGameState(prevGameState, updateTicksTime);
+			bool recorded = gameState->recordRenderCommands(prevGameState, updateTicksTime);
 			gameStateQueue->finishWritingToState();
+			if (recorded)
+				notifyGameStateRecorded();
+			#ifdef TRACK_REFERENCE_COUNT_STATS
+				gameStatesUpdatedCount++;
+			#endif
+			#ifdef DEBUG
+				//report the undo history size once a minute, not just when it gets trimmed
+				if (gameStateQueue->getStatesProducedCount() % (Config::updatesPerSecond * 60) == 0)
+					gameState->logUndoHistoryBytes();
+			#endif
 			prevGameState = gameState;
 			if (gameState->getShouldQuitGame())
 				break;
-		}
+		} else
+			gameStateQueue->markProducerStalled();
 
 		updateNum++;
 		updateDelay = Config::ticksPerSecond * updateNum / Config::updatesPerSecond - ((int)SDL_GetTicks() - startTime);
@@ -168,8 +270,29 @@ int gameMain(int argc, char* argv[]) {
 	//the render thread will quit once it reaches the game state that signalled that we should quit
 	renderLoopThread.join();
 	Logger::gameplayLogger.log("----   end gameplay ----");
+	stringstream gameStateQueueMessage;
+	gameStateQueueMessage
+		<< "GameStates: " << gameStateQueue->getStatesCount() << " allocated, "
+		<< gameStateQueue->getStatesProducedCount() << " produced, "
+		<< gameStateQueue->getStatesSkippedCount() << " skipped without rendering, "
+		<< gameStateQueue->getProducerStallsCount() << " updates stalled with no writable state";
+	Logger::debugLogger.logString(gameStateQueueMessage.str());
+	#ifdef TRACK_REFERENCE_COUNT_STATS
+		stringstream referenceCountsMessage;
+		referenceCountsMessage
+			<< "Update thread reference counts: "
+			<< PooledReferenceCounter::retainsCount << " retains, "
+			<< PooledReferenceCounter::releasesCount << " releases over "
+			<< gameStatesUpdatedCount << " updates ("
+			<< ((float)PooledReferenceCounter::retainsCount / (float)MathUtils::max(1, gameStatesUpdatedCount))
+			<< " retains and "
+			<< ((float)PooledReferenceCounter::releasesCount / (float)MathUtils::max(1, gameStatesUpdatedCount))
+			<< " releases per update)";
+		Logger::debugLogger.logString(referenceCountsMessage.str());
+	#endif
 
 	//cleanup anything that might have run a separate thread
+	PlayerState::endHintPrefetch();
 	delete gameStateQueue;
 	ObjectPool<PlayerState>::clearPool();
 
@@ -180,6 +303,7 @@ int gameMain(int argc, char* argv[]) {
 	Audio::unloadSounds();
 	Audio::tearDown();
 	#ifdef DEBUG
+		logObjectPoolStats();
 		MapState::deleteMap();
 		//the order that these object pools are cleared matters since some earlier classes in this list may have retained
 		//	objects from classes later in this list
@@ -211,7 +335,6 @@ int gameMain(int argc, char* argv[]) {
 		#ifdef STEAM
 			ObjectPool<EntityAnimation::UnlockEndGameAchievement>::clearPool();
 		#endif
-		ObjectPool<CollisionRect>::clearPool();
 		ObjectPool<KickAction>::clearPool();
 		ObjectPool<NoOpUndoState>::clearPool();
 		ObjectPool<MoveUndoState>::clearPool();
@@ -251,6 +374,7 @@ void renderLoop(CircularStateQueue<GameState>* gameStateQueue) {
 		renderThreadInitializingMutex.unlock();
 		return;
 	}
+	Opengl::setupNativeFrameBuffers();
 	EntityState::setupZoomFrameBuffers();
 	SDL_GL_SetSwapInterval(1);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -273,27 +397,49 @@ void renderLoop(CircularStateQueue<GameState>* gameStateQueue) {
 	while (true) {
 		int preRenderTicksTime = (int)SDL_GetTicks();
 
-		//adjust the viewport so that we scale the game window with the size of the screen
+		//track the size of the window so that we scale the game window with the size of the screen
 		SDL_GetWindowSize(window, &Config::windowDisplayWidth, &Config::windowDisplayHeight);
+		bool windowResized = false;
 		if (Config::windowDisplayWidth != lastWindowDisplayWidth || Config::windowDisplayHeight != lastWindowDisplayHeight) {
-			glViewport(0, 0, (GLsizei)Config::windowDisplayWidth, (GLsizei)Config::windowDisplayHeight);
+			windowResized = true;
 			Config::currentPixelWidth = (float)Config::windowDisplayWidth / (float)Config::windowScreenWidth;
 			Config::currentPixelHeight = (float)Config::windowDisplayHeight / (float)Config::windowScreenHeight;
 			lastWindowDisplayWidth = Config::windowDisplayWidth;
 			lastWindowDisplayHeight = Config::windowDisplayHeight;
 		}
 
+		//render at the game's native resolution and scale it up to the window once at the end
+		//if the newest state would draw the same frame as the one on screen, don't draw or present anything and keep
+		//	showing that frame, and check again next frame
+		Opengl::bindNativeFrameBuffer();
 		GameState* gameState = gameStateQueue->advanceToLastReadableState();
+		bool frameRendered = true;
 		if (gameState == nullptr)
 			GameState::renderLoading(preRenderTicksTime);
 		else
-			gameState->render(preRenderTicksTime);
-		glFlush();
-		SDL_GL_SwapWindow(window);
+			frameRendered = gameState->renderRecordedCommands(preRenderTicksTime, windowResized);
+		if (frameRendered) {
+			SpriteSheet::flushBatch();
+			Opengl::presentNativeFrame();
+			glFlush();
+			SDL_GL_SwapWindow(window);
+		}
+		if (gameState != nullptr)
+			firstGameStateRendered = true;
 
 		if (gameState != nullptr && gameState->getShouldQuitGame())
 			break;
 
+		//if there was nothing new to draw and nothing is animating, there won't be until the update thread records new
+		//	commands, so wait for it; check the window size every so often in case it changed
+		if (!frameRendered && !gameState->isAnimating()) {
+			unique_lock<mutex> gameStateRecordedLock (gameStateRecordedMutex);
+			gameStateRecordedCondition.wait_for(
+				gameStateRecordedLock, chrono::milliseconds(maxIdleRenderDelay), []() { return gameStateRecorded; });
+			gameStateRecorded = false;
+			continue;
+		}
+
 		int renderTime = (int)SDL_GetTicks() - preRenderTicksTime;
 		if (renderTime > lagFrameMs)
 			Logger::debugLogger.logString("lag frame took " + to_string(renderTime) + "ms");
@@ -315,6 +461,62 @@ void renderLoop(CircularStateQueue<GameState>* gameStateQueue) {
 	SDL_GL_DeleteContext(glContext);
 	Logger::debugLogger.log("Render thread ended");
 }
+void prewarmObjectPools() {
+	//every pool gets exactly one slab, which is what its first object would allocate anyway, so prewarming costs no extra
+	//	memory; logObjectPoolStats() shows the high-water marks to check whether a pool regularly outgrows its slab
+	//hint searches produce PotentialLevelStates on their own threads, in numbers that depend on the level, so there's no
+	//	point in prewarming them here
+	prewarmObjectPool(ConstantValue);
+	prewarmObjectPool(LinearInterpolatedValue);
+	prewarmObjectPool(CompositeQuarticValue);
+	prewarmObjectPool(PiecewiseValue);
+	prewarmObjectPool(TimeFunctionValue);
+	prewarmObjectPool(ExponentialValue);
+	prewarmObjectPool(EntityAnimation);
+	prewarmObjectPool(EntityAnimation::Delay);
+	prewarmObjectPool(EntityAnimation::SetPosition);
+	prewarmObjectPool(EntityAnimation::SetVelocity);
+	prewarmObjectPool(EntityAnimation::SetSpriteAnimation);
+	prewarmObjectPool(EntityAnimation::SetDirection);
+	prewarmObjectPool(EntityAnimation::PlaySound);
+	prewarmObjectPool(Particle);
+}
+#ifdef DEBUG
+	template <class PooledObject> void logPoolStatsForClass(const char* className, stringstream& message) {
+		message
+			<< "\n  " << className << ": " << ObjectPool<PooledObject>::getLiveCount() << " live, "
+			<< ObjectPool<PooledObject>::getHighWaterMark() << " high-water mark, "
+			<< ObjectPool<PooledObject>::getSlabMemoryBytes() << " bytes of slabs";
+	}
+	void logObjectPoolStats() {
+		stringstream message;
+		message << "Object pools:";
+		logPoolStats(ConstantValue, message);
+		logPoolStats(LinearInterpolatedValue, message);
+		logPoolStats(CompositeQuarticValue, message);
+		logPoolStats(PiecewiseValue, message);
+		logPoolStats(TimeFunctionValue, message);
+		logPoolStats(ExponentialValue, message);
+		logPoolStats(EntityAnimation, message);
+		logPoolStats(EntityAnimation::Delay, message);
+		logPoolStats(EntityAnimation::SetPosition, message);
+		logPoolStats(EntityAnimation::SetVelocity, message);
+		logPoolStats(EntityAnimation::SetSpriteAnimation, message);
+		logPoolStats(EntityAnimation::SetDirection, message);
+		logPoolStats(EntityAnimation::PlaySound, message);
+		logPoolStats(Particle, message);
+		logPoolStats(HintState::PotentialLevelState, message);
+		logPoolStats(MapState, message);
+		logPoolStats(PlayerState, message);
+		logPoolStats(NoOpUndoState, message);
+		logPoolStats(MoveUndoState, message);
+		logPoolStats(ClimbFallUndoState, message);
+		logPoolStats(RideRailUndoState, message);
+		logPoolStats(KickSwitchUndoState, message);
+		logPoolStats(KickResetSwitchUndoState, message);
+		Logger::debugLogger.logString(message.str());
+	}
+#endif
 int messageBox(const char* message, UINT messageBoxType) {
 	return MessageBoxA(nullptr, message, "Kick Yourself On: Initialization Error", messageBoxType);
 }
@@ -325,3 +527,9 @@ void waitForOtherThread(mutex& waitMutex, bool* resumeCondition) {
 		waitMutex.unlock();
 	}
 }
+void notifyGameStateRecorded() {
+	gameStateRecordedMutex.lock();
+	gameStateRecorded = true;
+	gameStateRecordedMutex.unlock();
+	gameStateRecordedCondition.notify_one();
+}
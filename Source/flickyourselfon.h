@@ -7,9 +7,18 @@ class GameState;
 int gameMain(int argc, char* argv[]);
 //main render loop for the game
 void renderLoop(CircularStateQueue<GameState>* gameStateQueue);
+//fill one slab for each of the object pools that gameplay uses the most so that updates don't have to construct new objects
+//must be called after the map is built
+void prewarmObjectPools();
+#ifdef DEBUG
+	//log the live count, high-water mark, and slab memory of the object pools that gameplay uses the most
+	void logObjectPoolStats();
+#endif
 //show a popup message box
 //returns the result of the message box
 int messageBox(const char* message, UINT messageBoxType);
 //wait for another thread to set the given condition to true after it locks the given mutex, using a combination of sleeping and
 //	locking/unlocking the given mutex
 void waitForOtherThread(mutex& waitMutex, bool* resumeCondition);
+//wake the render thread if it's waiting for new render commands
+void notifyGameStateRecorded();